@@ -25,12 +25,19 @@
    */
 
 #include "UdpSocket.h"
+#include "Log.h"
+#include "Utils.h"
 
 #include <iostream>
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 using namespace std;
 
@@ -67,6 +74,69 @@ int UdpSocket::setBlocking(bool block)
     return 0;
 }
 
+int UdpSocket::setReceiveBufferSize(size_t size)
+{
+    int value = size;
+#ifdef SO_RCVBUFFORCE
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_RCVBUFFORCE,
+                &value, sizeof(value)) == 0) {
+        return 0;
+    }
+#endif
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_RCVBUF,
+                &value, sizeof(value)) == SOCKET_ERROR) {
+        setInetError("Can't set receive buffer size");
+        return -1;
+    }
+    return 0;
+}
+
+size_t UdpSocket::getReceiveBufferSize()
+{
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (getsockopt(listenSocket, SOL_SOCKET, SO_RCVBUF,
+                &value, &len) == SOCKET_ERROR) {
+        setInetError("Can't get receive buffer size");
+        return 0;
+    }
+    return value;
+}
+
+int UdpSocket::setReceiveTimeout(int timeout_ms)
+{
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_RCVTIMEO,
+                &tv, sizeof(tv)) == SOCKET_ERROR) {
+        setInetError("Can't set receive timeout");
+        return -1;
+    }
+    return 0;
+}
+
+int UdpSocket::enableReceiveInfo()
+{
+    int enable = 1;
+#ifdef SO_TIMESTAMPNS
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_TIMESTAMPNS,
+                &enable, sizeof(enable)) == SOCKET_ERROR) {
+        setInetError("Can't enable reception timestamps");
+        return -1;
+    }
+#endif
+#ifdef SO_RXQ_OVFL
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_RXQ_OVFL,
+                &enable, sizeof(enable)) == SOCKET_ERROR) {
+        setInetError("Can't enable the dropped packets counter");
+        return -1;
+    }
+#endif
+    (void)enable;
+    return 0;
+}
+
 int UdpSocket::reinit(int port, const std::string& name)
 {
     if (listenSocket != INVALID_SOCKET) {
@@ -254,29 +324,82 @@ InetAddress UdpPacket::getAddress()
 }
 
 UdpReceiver::~UdpReceiver() {
+    // The receive timeout lets the thread see m_stop, the socket
+    // must only be closed once it stopped using it.
     m_stop = true;
-    m_sock.close();
     if (m_thread.joinable()) {
         m_thread.join();
     }
+    m_sock.close();
 }
 
-void UdpReceiver::start(int port, size_t max_packets_queued) {
+void UdpReceiver::start(int port, size_t num_buffers, size_t rcvbuf_size) {
+    if (num_buffers == 0 or num_buffers >= UINT32_MAX) {
+        throw invalid_argument("UDP Receiver: invalid number of buffers");
+    }
+
     m_port = port;
-    m_max_packets_queued = max_packets_queued;
+
+    if (m_sock.reinit(m_port, "0.0.0.0") == -1 or
+            m_sock.setReceiveBufferSize(rcvbuf_size) == -1 or
+            m_sock.setReceiveTimeout(100) == -1 or
+            m_sock.enableReceiveInfo() == -1) {
+        throw runtime_error(string("UDP Receiver: ") + inetErrMsg);
+    }
+    m_rcvbuf_size = m_sock.getReceiveBufferSize();
+
+    // Zero-filled, so that the pages are in place before the first burst
+    m_buffers.assign(num_buffers * max_packet_size, 0);
+    m_sizes.assign(num_buffers, 0);
+    m_timestamps.assign(num_buffers, {0, 0});
+
+    // One more slot for the index that tells the consumer the receiver
+    // stopped, so that pushing never has to wait.
+    m_free.reset(new SpscQueue<uint32_t>(num_buffers + 1));
+    m_received.reset(new SpscQueue<uint32_t>(num_buffers + 1));
+
+    for (size_t i = 0; i < num_buffers; i++) {
+        m_free->push(i);
+    }
+
     m_thread = std::thread(&UdpReceiver::m_run, this);
 }
 
-std::vector<uint8_t> UdpReceiver::get_packet_buffer()
+// Index pushed into m_received when the receiving thread stops
+static const uint32_t receiver_stopped = UINT32_MAX;
+
+struct timespec UdpReceiver::get_packet(std::vector<uint8_t>& buf,
+        size_t prebuffering)
 {
-    if (m_stop) {
+    if (not m_received) {
         throw runtime_error("UDP Receiver not running");
     }
+    else if (m_stopped) {
+        throw runtime_error("UDP Receiver stopped: " + m_error);
+    }
+
+    uint32_t ix = 0;
+    m_received->wait_and_pop(ix,
+            std::min(std::max<size_t>(prebuffering, 1), m_sizes.size()));
+
+    if (ix == receiver_stopped) {
+        // The receiving thread set m_error before it pushed the index
+        m_stopped = true;
+        throw runtime_error("UDP Receiver stopped: " + m_error);
+    }
 
-    UdpPacket p;
-    m_packets.wait_and_pop(p);
+    const uint8_t *data = buffer_data(ix);
+    buf.assign(data, data + m_sizes[ix]);
+    const struct timespec timestamp = m_timestamps[ix];
 
-    return p.getBuffer();
+    m_free->push(ix);
+
+    return timestamp;
+}
+
+uint8_t* UdpReceiver::buffer_data(uint32_t ix)
+{
+    return &m_buffers[ix * max_packet_size];
 }
 
 void UdpReceiver::m_run()
@@ -288,30 +411,138 @@ void UdpReceiver::m_run()
         private: atomic<bool>& m_stop;
     } autoSetStop(m_stop);
 
-    m_sock.reinit(m_port, "0.0.0.0");
+    set_thread_name("udpreceiver");
 
-    const size_t packsize = 8192;
-    UdpPacket packet(packsize);
+    vector<uint32_t> batch(max_batch);
+    size_t batch_len = 0;
+
+#if defined(HAVE_RECVMMSG)
+    // Room for the reception timestamp and the dropped packets counter
+    union control_t {
+        char buf[CMSG_SPACE(sizeof(struct timespec)) +
+            CMSG_SPACE(sizeof(uint32_t))];
+        struct cmsghdr align;
+    };
+
+    vector<struct mmsghdr> msgs(max_batch);
+    vector<struct iovec> iovecs(max_batch);
+    vector<control_t> control(max_batch);
+#endif
+
+    const SOCKET sock = m_sock.getNativeSocket();
 
     while (not m_stop) {
-        int ret = m_sock.receive(packet);
-        if (ret == 0) {
-            if (packet.getSize() == packsize) {
-                // TODO replace fprintf
-                fprintf(stderr, "Warning, possible UDP truncation\n");
+        // Buffers taken but not filled by the previous call stay in batch
+        uint32_t ix = 0;
+        while (batch_len < max_batch and m_free->try_pop(ix)) {
+            batch[batch_len++] = ix;
+        }
+
+        if (batch_len == 0) {
+            // The consumer is behind, let the kernel buffer the packets
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+
+#if defined(HAVE_RECVMMSG)
+        for (size_t i = 0; i < batch_len; i++) {
+            iovecs[i].iov_base = buffer_data(batch[i]);
+            iovecs[i].iov_len = max_packet_size;
+
+            struct msghdr& hdr = msgs[i].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_iov = &iovecs[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = control[i].buf;
+            hdr.msg_controllen = sizeof(control[i].buf);
+        }
+
+        // Wait for the first packet, then take what is already there
+        const int ret = recvmmsg(sock, msgs.data(), batch_len,
+                MSG_WAITFORONE, nullptr);
+
+        for (int i = 0; i < ret; i++) {
+            const struct msghdr& hdr = msgs[i].msg_hdr;
+            m_sizes[batch[i]] = msgs[i].msg_len;
+
+            if (hdr.msg_flags & MSG_TRUNC) {
+                etiLog.level(warn) << "UDP Receiver: packet truncated to " <<
+                    max_packet_size << " bytes";
             }
 
-            // If this blocks, the UDP socket will lose incoming packets
-            m_packets.push_wait_if_full(packet, m_max_packets_queued);
+            bool have_timestamp = false;
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+                    cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&hdr), cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET) {
+                    continue;
+                }
+#ifdef SO_TIMESTAMPNS
+                if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    memcpy(&m_timestamps[batch[i]], CMSG_DATA(cmsg),
+                            sizeof(struct timespec));
+                    have_timestamp = true;
+                }
+#endif
+#ifdef SO_RXQ_OVFL
+                if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t drops = 0;
+                    memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                    m_kernel_drops = drops;
+                }
+#endif
+            }
+
+            if (not have_timestamp) {
+                clock_gettime(CLOCK_REALTIME, &m_timestamps[batch[i]]);
+            }
+        }
+#else
+        // Wait for the first packet, then take what is already there
+        int ret = 0;
+        while ((size_t)ret < batch_len) {
+            const ssize_t len = recvfrom(sock, buffer_data(batch[ret]),
+                    max_packet_size, ret == 0 ? 0 : MSG_DONTWAIT,
+                    nullptr, nullptr);
+            if (len == SOCKET_ERROR) {
+                if (ret == 0) {
+                    ret = SOCKET_ERROR;
+                }
+                break;
+            }
+
+            if ((size_t)len == max_packet_size) {
+                etiLog.level(warn) << "UDP Receiver: possible truncation";
+            }
+            m_sizes[batch[ret]] = len;
+            clock_gettime(CLOCK_REALTIME, &m_timestamps[batch[ret]]);
+            ret++;
         }
-        else
-        {
-            if (inetErrNo != EINTR) {
-                // TODO replace fprintf
-                fprintf(stderr, "Socket error: %s\n", inetErrMsg);
+#endif
+
+        if (ret == SOCKET_ERROR) {
+            if (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR) {
+                continue;
             }
-            m_stop = true;
+            setInetError("Can't receive UDP packet");
+            m_error = inetErrMsg;
+            etiLog.level(error) << "UDP Receiver: " << m_error;
+            break;
         }
+
+        m_packets_received += ret;
+
+        for (int i = 0; i < ret; i++) {
+            m_received->push(batch[i]);
+        }
+
+        copy(batch.begin() + ret, batch.begin() + batch_len, batch.begin());
+        batch_len -= ret;
+    }
+
+    if (m_error.empty()) {
+        m_error = "stop requested";
     }
-}
 
+    // Wake up the consumer
+    m_received->push(receiver_stopped);
+}
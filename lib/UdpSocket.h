@@ -31,13 +31,14 @@
 #endif
 
 #include "InetAddress.h"
-#include "ThreadsafeQueue.h"
+#include "SpscQueue.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <pthread.h>
+#include <time.h>
 #define SOCKET           int
 #define INVALID_SOCKET   -1
 #define SOCKET_ERROR     -1
@@ -48,6 +49,8 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <string>
 
 class UdpPacket;
 
@@ -121,6 +124,37 @@ class UdpSocket
          */
         int setBlocking(bool block);
 
+        /** Set the size of the kernel receive buffer. Uses SO_RCVBUFFORCE
+         *  when the process is allowed to, otherwise the size is limited
+         *  by net.core.rmem_max.
+         *  @return 0  if ok
+         *          -1 if error
+         */
+        int setReceiveBufferSize(size_t size);
+
+        /** Get the size of the kernel receive buffer, as reported by the
+         *  system.
+         *  @return the size in bytes, 0 if error
+         */
+        size_t getReceiveBufferSize(void);
+
+        /** Make blocking reads return after timeout_ms milliseconds even
+         *  if no packet arrived.
+         *  @return 0  if ok
+         *          -1 if error
+         */
+        int setReceiveTimeout(int timeout_ms);
+
+        /** Ask the kernel to attach the reception timestamp and the
+         *  counter of dropped packets to every received packet, where
+         *  the system supports it.
+         *  @return 0  if ok
+         *          -1 if error
+         */
+        int enableReceiveInfo(void);
+
+        SOCKET getNativeSocket(void) const { return listenSocket; }
+
     protected:
 
         /// The address on which the socket is bound.
@@ -175,29 +209,97 @@ class UdpPacket
         InetAddress address;
 };
 
-/* Threaded UDP receiver */
+/* Threaded UDP receiver
+ *
+ * The receiving thread reads the packets in batches with recvmmsg(), or
+ * with a loop of recvfrom() where recvmmsg() is missing, into a pool of
+ * packet buffers. The buffers circulate between the receiving thread and
+ * the consumer through two SpscQueues, one for the free buffers and one
+ * for the received packets, so that nothing gets allocated or copied per
+ * packet on the receiving side.
+ *
+ * The whole pool is allocated and touched in start(), the receiving thread
+ * never allocates. When all buffers are waiting for the consumer, the
+ * receiving thread stops reading and the packets accumulate in the kernel
+ * receive buffer. Whatever the kernel has to drop is counted, see
+ * kernel_drops().
+ *
+ * Every packet carries its SO_TIMESTAMPNS reception time, or the time the
+ * receiving thread got it where the system does not support it.
+ */
 class UdpReceiver {
     public:
-        UdpReceiver() : m_port(0), m_thread(), m_stop(false), m_packets() {}
+        // Largest packet that can be received without truncation
+        static constexpr size_t max_packet_size = 8192;
+
+        // Number of packets received with one system call
+        static constexpr size_t max_batch = 32;
+
+        UdpReceiver() : m_port(0), m_thread(), m_stop(false),
+            m_packets_received(0), m_kernel_drops(0) {}
         ~UdpReceiver();
         UdpReceiver(const UdpReceiver&) = delete;
         UdpReceiver operator=(const UdpReceiver&) = delete;
 
-        // Start the receiver in a separate thread
-        void start(int port, size_t max_packets_queued);
+        /* Open the socket, allocate num_buffers packet buffers and start
+         * the receiver in a separate thread. Up to num_buffers packets can
+         * be waiting for the consumer. The kernel receive buffer is set to
+         * rcvbuf_size bytes, or to the largest size the system allows.
+         * In case of error, throws a runtime_error
+         */
+        void start(int port, size_t num_buffers, size_t rcvbuf_size);
+
+        /* Copy the data contained in the next UDP packet into buf, reusing
+         * its storage, and return its reception time (CLOCK_REALTIME).
+         * Blocks if none available, or until prebuffering packets are
+         * available.
+         * In case of error, throws a runtime_error
+         */
+        struct timespec get_packet(std::vector<uint8_t>& buf,
+                size_t prebuffering = 1);
+
+        // Number of packets waiting in the queue
+        size_t packets_queued(void) const {
+            return m_received ? m_received->size() : 0;
+        }
+
+        // Number of packets received since the start
+        size_t packets_received(void) const { return m_packets_received; }
 
-        // Get the data contained in a UDP packet, blocks if none available
-        // In case of error, throws a runtime_error
-        std::vector<uint8_t> get_packet_buffer(void);
+        // Number of packets the kernel dropped because its receive
+        // buffer was full. Stays 0 where the system does not count them.
+        size_t kernel_drops(void) const { return m_kernel_drops; }
+
+        // Size of the kernel receive buffer the system granted
+        size_t receive_buffer_size(void) const { return m_rcvbuf_size; }
 
     private:
         void m_run(void);
 
+        uint8_t* buffer_data(uint32_t ix);
+
         int m_port;
-        size_t m_max_packets_queued;
+        size_t m_rcvbuf_size = 0;
         std::thread m_thread;
         std::atomic<bool> m_stop;
-        ThreadsafeQueue<UdpPacket> m_packets;
+        std::atomic<size_t> m_packets_received;
+        std::atomic<size_t> m_kernel_drops;
+
+        // Written by the receiving thread before it stops
+        std::string m_error;
+        // Set by the consumer once it saw the receiver stop
+        bool m_stopped = false;
+
+        // The packet buffers, of max_packet_size bytes each, with the
+        // size and the reception time of the packet they hold
+        std::vector<uint8_t> m_buffers;
+        std::vector<size_t> m_sizes;
+        std::vector<struct timespec> m_timestamps;
+
+        // Indices of the buffers
+        std::unique_ptr<SpscQueue<uint32_t> > m_free;
+        std::unique_ptr<SpscQueue<uint32_t> > m_received;
+
         UdpSocket m_sock;
 };
 
@@ -0,0 +1,343 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Offline modulation of an ETI file into an IQ file, faster than real time
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchModulator.h"
+#include "DabModulator.h"
+#include "EtiReader.h"
+#include "Eti.h"
+#include "Flowgraph.h"
+#include "FormatConverter.h"
+#include "FrequencyShift.h"
+#include "MemlessPoly.h"
+#include "Log.h"
+#include "PcDebug.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* Writes the outputs of one modulator at their place in the output file,
+ * and drops the ones of the warm-up.
+ */
+class BatchOutput : public ModOutput
+{
+public:
+    BatchOutput(int fd, size_t first_output,
+            size_t output_begin, size_t output_end) :
+        m_fd(fd),
+        m_output(first_output),
+        m_output_begin(output_begin),
+        m_output_end(output_end) {}
+
+    int process(Buffer* dataIn) override
+    {
+        const size_t length = dataIn->getLength();
+        if (m_length == 0) {
+            m_length = length;
+        }
+        else if (length != m_length) {
+            throw runtime_error("BatchOutput: the size of the "
+                    "transmission frames changed, batch mode impossible");
+        }
+
+        if (m_output >= m_output_begin and m_output < m_output_end) {
+            const uint8_t* data =
+                reinterpret_cast<const uint8_t*>(dataIn->getData());
+            off_t offset = m_output * length;
+            size_t remaining = length;
+            while (remaining > 0) {
+                const ssize_t ret = pwrite(m_fd, data, remaining, offset);
+                if (ret == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw runtime_error(string("BatchOutput: write error: ") +
+                            strerror(errno));
+                }
+                data += ret;
+                offset += ret;
+                remaining -= ret;
+            }
+        }
+        m_output++;
+
+        return length;
+    }
+
+    const char* name() override { return "BatchOutput"; }
+
+private:
+    int m_fd;
+    size_t m_output; // index in the output file of the next output
+    size_t m_output_begin;
+    size_t m_output_end;
+    size_t m_length = 0;
+};
+
+
+BatchModulator::BatchModulator(const mod_settings_t& settings,
+        unsigned num_workers) :
+    m_settings(settings),
+    m_num_workers(num_workers),
+    m_frames_done(0)
+{
+    if (m_settings.inputTransport != "file" or m_settings.loop) {
+        throw invalid_argument(
+                "Batch mode requires a file input without loop");
+    }
+    if (not m_settings.useFileOutput) {
+        throw invalid_argument("Batch mode requires a file output");
+    }
+
+    if (m_num_workers == 0) {
+        m_num_workers = std::max(1u, thread::hardware_concurrency());
+    }
+
+    if (m_input.Open(m_settings.inputName, false) == -1) {
+        throw runtime_error("Unable to open input file!");
+    }
+    if (not m_input.IsMapped()) {
+        throw runtime_error("Batch mode requires a regular input file");
+    }
+
+    m_output_fd = open(m_settings.outputName.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (m_output_fd == -1) {
+        throw runtime_error("Unable to open output file " +
+                m_settings.outputName + ": " + strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(m_output_fd, &st) == -1 or not S_ISREG(st.st_mode)) {
+        close(m_output_fd);
+        throw runtime_error("Batch mode requires a regular output file");
+    }
+
+    plan_segments();
+}
+
+BatchModulator::~BatchModulator()
+{
+    if (m_output_fd != -1) {
+        close(m_output_fd);
+    }
+}
+
+void BatchModulator::plan_segments()
+{
+    const size_t nb_frames = m_input.GetNbFrames();
+    if (nb_frames == 0) {
+        return;
+    }
+
+    vector<uint8_t> buffer(6144);
+    const uint8_t* frame = nullptr;
+    m_input.GetFrameAt(0, buffer.data(), &frame);
+    const eti_FC* fc = reinterpret_cast<const eti_FC*>(frame + 4);
+
+    unsigned mode = m_settings.dabMode;
+    if (mode == 0) {
+        mode = (fc->MID == 0) ? 4 : fc->MID;
+    }
+
+    // The number of CIFs per transmission frame, see BlockPartitioner
+    const size_t cif_count = (mode == 1) ? 4 : (mode == 4) ? 2 : 1;
+
+    // The BlockPartitioner drops the CIFs before the first transmission
+    // frame boundary, the following boundaries are every cif_count frames.
+    const size_t first_tf = (cif_count - fc->FP % cif_count) % cif_count;
+
+    // Number of outputs the pipelined blocks delay the signal by
+    size_t delay = m_settings.tist_delay_stages;
+    if (not m_settings.polyCoefFilename.empty()) {
+        delay += MEMLESSPOLY_PIPELINE_DELAY;
+    }
+
+    /* The first output written by a modulator belongs to a transmission
+     * frame that must only depend on frames the modulator has seen for
+     * long enough: the 16 CIFs of the TimeInterleaver history, the
+     * previous transmission frame for the Resampler overlap, and the
+     * delay of the pipelined blocks. The warm-up is a whole number of
+     * pairs of transmission frames, so that the TII toggles in phase.
+     */
+    const size_t pair = 2 * cif_count;
+    const size_t min_warmup = 15 + cif_count + delay * cif_count;
+    const size_t warmup = (min_warmup + pair - 1) / pair * pair;
+
+    const size_t nb_pairs = (nb_frames - first_tf) / pair;
+
+    // Keep the warm-up overhead low on short files
+    size_t num_segments = m_num_workers;
+    num_segments = std::min(num_segments,
+            std::max<size_t>(1, nb_frames / (4 * warmup)));
+
+    m_segments.clear();
+    for (size_t k = 0; k < num_segments; k++) {
+        segment_t s;
+        if (k == 0) {
+            s.segment_frame = 0;
+            s.output_begin = 0;
+        }
+        else {
+            s.segment_frame = first_tf + pair * (k * nb_pairs / num_segments);
+            s.output_begin = (s.segment_frame - first_tf) / cif_count;
+        }
+
+        if (s.segment_frame >= first_tf + warmup) {
+            s.first_frame = s.segment_frame - warmup;
+            s.first_output = (s.first_frame - first_tf) / cif_count;
+        }
+        else {
+            // Start like a single modulator would
+            s.first_frame = 0;
+            s.first_output = 0;
+        }
+
+        if (k > 0) {
+            m_segments.back().end_frame = s.segment_frame;
+            m_segments.back().output_end = s.output_begin;
+        }
+        s.end_frame = nb_frames;
+        s.output_end = numeric_limits<size_t>::max();
+        m_segments.push_back(s);
+    }
+
+    etiLog.level(info) << "Batch mode: " << nb_frames << " frames in " <<
+        m_segments.size() << " segments, warm-up of " << warmup << " frames";
+}
+
+size_t BatchModulator::run(volatile sig_atomic_t& running)
+{
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+
+    vector<thread> threads;
+    vector<exception_ptr> exceptions(m_segments.size());
+
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        threads.emplace_back([this, i, &exceptions, &running]() {
+                set_thread_name("batch");
+                try {
+                    modulate_segment(m_segments[i], running);
+                }
+                catch (...) {
+                    exceptions[i] = current_exception();
+                    running = 0;
+                }
+            });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (auto& e : exceptions) {
+        if (e) {
+            rethrow_exception(e);
+        }
+    }
+
+    const double duration =
+        duration_cast<milliseconds>(steady_clock::now() - start).count() /
+        1000.0;
+    const size_t frames = m_frames_done.load();
+    etiLog.level(info) << "Batch mode: " << frames << " frames in " <<
+        duration << " s, " << (frames * 0.024 / duration) <<
+        " times real time";
+
+    return frames;
+}
+
+void BatchModulator::modulate_segment(const segment_t& segment,
+        volatile sig_atomic_t& running)
+{
+    PDEBUG("BatchModulator::modulate_segment(%zu, %zu, %zu)\n",
+            segment.first_frame, segment.segment_frame, segment.end_frame);
+
+    // The TimestampDecoder keeps a reference to the offset
+    double tist_offset_s = m_settings.tist_offset_s;
+
+    EtiReader etiReader(tist_offset_s, m_settings.tist_delay_stages);
+    Flowgraph flowgraph;
+
+    /* The frequency shift follows the modulator, so that its phase
+     * continues from the preceding segment.
+     */
+    mod_settings_t settings = m_settings;
+    settings.enableFreqShift = false;
+
+    auto modulator = make_shared<DabModulator>(etiReader, settings);
+    auto output = make_shared<BatchOutput>(m_output_fd,
+            segment.first_output, segment.output_begin,
+            segment.output_end);
+
+    shared_ptr<ModPlugin> last = modulator;
+    if (m_settings.enableFreqShift) {
+        auto shift = make_shared<FrequencyShift>(m_settings.freqShiftOffset,
+                m_settings.outputRate, segment.first_output);
+        flowgraph.connect(modulator, shift);
+        last = shift;
+    }
+
+    if (m_settings.fileOutputFormat == "s8" or
+            m_settings.fileOutputFormat == "u8") {
+        auto format_converter =
+            make_shared<FormatConverter>(m_settings.fileOutputFormat);
+        flowgraph.connect(last, format_converter);
+        flowgraph.connect(format_converter, output);
+    }
+    else {
+        flowgraph.connect(last, output);
+    }
+
+    vector<uint8_t> buffer(6144);
+
+    for (size_t i = segment.first_frame;
+            i < segment.end_frame and running; i++) {
+        const uint8_t* frame = nullptr;
+        const int framesize = m_input.GetFrameAt(i, buffer.data(), &frame);
+
+        if (etiReader.loadEtiData(frame, framesize) != framesize) {
+            throw runtime_error("ETI frame incompletely read");
+        }
+
+        flowgraph.run();
+
+        if (i >= segment.segment_frame) {
+            m_frames_done++;
+        }
+    }
+}
+
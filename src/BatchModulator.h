@@ -0,0 +1,98 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Offline modulation of an ETI file into an IQ file, faster than real time
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ConfigParser.h"
+#include "InputReader.h"
+
+#include <atomic>
+#include <signal.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+/* The batch mode modulates an ETI file into an IQ file with several
+ * complete modulators running side by side, each one on a contiguous
+ * segment of the input. Every modulator writes its transmission frames
+ * directly at their place in the output file, which ends up identical
+ * to the one a single modulator would write.
+ *
+ * The blocks that keep state across frames (TimeInterleaver history,
+ * Resampler overlap, pipelined blocks, TII toggle) are brought into the
+ * same state by letting each modulator start a few transmission frames
+ * before its segment, and discarding that warm-up output. The segments
+ * are aligned to the CIF phase the BlockPartitioner synchronises to.
+ *
+ * This requires a regular input file that can be memory-mapped, in which
+ * the frame phase FP increments continuously, and a regular output file.
+ */
+class BatchModulator
+{
+public:
+    /* num_workers is the number of modulators, 0 uses one per CPU */
+    BatchModulator(const mod_settings_t& settings, unsigned num_workers);
+    BatchModulator(const BatchModulator&) = delete;
+    BatchModulator& operator=(const BatchModulator&) = delete;
+    ~BatchModulator();
+
+    /* Modulate the whole input file. Returns the number of ETI frames
+     * modulated, stops early when running is cleared.
+     */
+    size_t run(volatile sig_atomic_t& running);
+
+private:
+    struct segment_t {
+        // ETI frames [first_frame, end_frame) are given to the modulator,
+        // the segment itself starts at segment_frame
+        size_t first_frame;
+        size_t segment_frame;
+        size_t end_frame;
+        // Index in the output file of the first output of the modulator
+        size_t first_output;
+        // Outputs [output_begin, output_end) are written, the ones
+        // before are the warm-up
+        size_t output_begin;
+        size_t output_end;
+    };
+
+    void plan_segments();
+    void modulate_segment(const segment_t& segment,
+            volatile sig_atomic_t& running);
+
+    const mod_settings_t& m_settings;
+    unsigned m_num_workers;
+
+    InputFileReader m_input;
+    int m_output_fd = -1;
+
+    std::vector<segment_t> m_segments;
+    std::atomic<size_t> m_frames_done;
+};
+
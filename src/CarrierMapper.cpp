@@ -0,0 +1,143 @@
+/*
+   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
+   the Queen in Right of Canada (Communications Research Center Canada)
+
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    This flowgraph block maps the CIF data to the differentially modulated
+    carriers, fusing QPSK mapping, frequency interleaving and differential
+    modulation.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CarrierMapper.h"
+#include "DabModeTraits.h"
+#include "PcDebug.h"
+
+#include <stdexcept>
+#include <string>
+#include <string.h>
+
+CarrierMapper::CarrierMapper(unsigned mode, size_t carriers) :
+    ModMux(),
+    d_carriers(carriers),
+    d_mapper(carriers),
+    d_interleaver(mode),
+    d_modulator(carriers)
+{
+    PDEBUG("CarrierMapper::CarrierMapper(%u, %zu) @ %p\n",
+            mode, carriers, this);
+
+    switch (mode) {
+    case 1:
+        d_process_symbols = &CarrierMapper::process_symbols<1>;
+        break;
+    case 2:
+        d_process_symbols = &CarrierMapper::process_symbols<2>;
+        break;
+    case 3:
+        d_process_symbols = &CarrierMapper::process_symbols<3>;
+        break;
+    case 0:
+    case 4:
+        d_process_symbols = &CarrierMapper::process_symbols<4>;
+        break;
+    default:
+        throw std::runtime_error(
+                "CarrierMapper::CarrierMapper invalid mode " +
+                std::to_string(mode));
+    }
+
+    // The mode fixes the number of carriers
+    const size_t mode_carriers[] = {
+        DabModeTraits<4>::nbCarriers,
+        DabModeTraits<1>::nbCarriers,
+        DabModeTraits<2>::nbCarriers,
+        DabModeTraits<3>::nbCarriers,
+        DabModeTraits<4>::nbCarriers };
+    if (carriers != mode_carriers[mode]) {
+        throw std::runtime_error(
+                "CarrierMapper::CarrierMapper " + std::to_string(carriers) +
+                " carriers invalid for mode " + std::to_string(mode));
+    }
+}
+
+
+template<unsigned Mode>
+void CarrierMapper::process_symbols(
+        const uint8_t* in, complexf* out, size_t nbSymbols)
+{
+    const size_t carriers = DabModeTraits<Mode>::nbCarriers;
+
+    // Phase indices of the current symbol, before and after interleaving
+    uint8_t mapped[carriers];
+    uint8_t interleaved[carriers];
+
+    for (size_t i = 0; i < nbSymbols; ++i) {
+        d_mapper.map_symbol<carriers>(in, mapped);
+        d_interleaver.interleave_symbol<carriers>(mapped, interleaved);
+        d_modulator.modulate_symbol<carriers>(interleaved, out);
+        in += carriers / 4;
+        out += carriers;
+    }
+}
+
+
+int CarrierMapper::process(std::vector<Buffer*> dataIn, Buffer* dataOut)
+{
+    PDEBUG("CarrierMapper::process(dataIn: %zu, dataOut: %p)\n",
+            dataIn.size(), dataOut);
+
+    if (dataIn.size() != 2) {
+        throw std::runtime_error(
+                "CarrierMapper::process nb of input streams not 2!");
+    }
+
+    const size_t symbolSize = d_carriers / 4;
+    const size_t phaseSize = dataIn[0]->getLength() / sizeof(complexf);
+    const size_t cifSize = dataIn[1]->getLength();
+
+    if (phaseSize != d_carriers) {
+        throw std::runtime_error(
+                "CarrierMapper::process input phase size not valid!");
+    }
+    if (cifSize % symbolSize != 0) {
+        throw std::runtime_error(
+                "CarrierMapper::process input size " +
+                std::to_string(cifSize) + " not valid!");
+    }
+
+    const size_t nbSymbols = cifSize / symbolSize;
+    dataOut->setLength((1 + nbSymbols) * d_carriers * sizeof(complexf));
+
+    const complexf* phase =
+        reinterpret_cast<const complexf*>(dataIn[0]->getData());
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn[1]->getData());
+    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
+
+    memcpy(out, phase, d_carriers * sizeof(complexf));
+    d_modulator.set_reference(phase);
+    out += d_carriers;
+
+    (this->*d_process_symbols)(in, out, nbSymbols);
+
+    return dataOut->getLength();
+}
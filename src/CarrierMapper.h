@@ -0,0 +1,77 @@
+/*
+   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
+   the Queen in Right of Canada (Communications Research Center Canada)
+
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    This flowgraph block maps the CIF data to the differentially modulated
+    carriers, fusing QPSK mapping, frequency interleaving and differential
+    modulation.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "QpskSymbolMapper.h"
+#include "FrequencyInterleaver.h"
+#include "DifferentialModulator.h"
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <vector>
+
+/* The CarrierMapper replaces the QpskSymbolMapper -> FrequencyInterleaver
+ * -> DifferentialModulator chain. It processes one OFDM symbol at a time
+ * through two small scratch buffers, and writes the modulated carriers
+ * directly into its output buffer, in the order the OfdmGenerator expects.
+ * The symbol loop is instantiated for every transmission mode, and
+ * selected at construction.
+ */
+class CarrierMapper : public ModMux
+{
+public:
+    CarrierMapper(unsigned mode, size_t carriers);
+    CarrierMapper(const CarrierMapper&) = delete;
+    CarrierMapper& operator=(const CarrierMapper&) = delete;
+
+    // dataIn[0] -> phase reference
+    // dataIn[1] -> CIF data, d_carriers/4 bytes per OFDM symbol
+    int process(std::vector<Buffer*> dataIn, Buffer* dataOut);
+    const char* name() { return "CarrierMapper"; }
+
+private:
+    // Map, interleave and modulate nbSymbols OFDM symbols
+    template<unsigned Mode>
+    void process_symbols(const uint8_t* in, complexf* out, size_t nbSymbols);
+
+    size_t d_carriers;
+    void (CarrierMapper::*d_process_symbols)(
+            const uint8_t*, complexf*, size_t);
+
+    QpskSymbolMapper d_mapper;
+    FrequencyInterleaver d_interleaver;
+    DifferentialModulator d_modulator;
+};
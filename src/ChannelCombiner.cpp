@@ -0,0 +1,150 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Combines the signals of several modulators into one wideband signal
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ChannelCombiner.h"
+#include "PcDebug.h"
+
+#include <stdexcept>
+#include <string>
+
+// The threads mix ranges of whole cache lines
+static const size_t mix_granularity = 64;
+
+class CombinerInput : public ModOutput
+{
+public:
+    CombinerInput(SpscQueue<Buffer::sptr>& queue) : m_queue(queue) {}
+
+    int process(Buffer* dataIn) override
+    {
+        // The modulator reuses its buffer for the next frame
+        m_queue.push(std::make_shared<Buffer>(
+                    dataIn->getLength(), dataIn->getData()));
+        return dataIn->getLength();
+    }
+
+    const char* name() override { return "CombinerInput"; }
+
+private:
+    SpscQueue<Buffer::sptr>& m_queue;
+};
+
+ChannelCombiner::channel_t::channel_t(double offset, size_t sampleRate) :
+    queue(4),
+    nco(offset, sampleRate)
+{
+}
+
+ChannelCombiner::ChannelCombiner(size_t sampleRate,
+        const std::vector<double>& offsets,
+        size_t num_threads) :
+    ModInput(),
+    m_sampleRate(sampleRate),
+    m_channels(),
+    m_pool(num_threads > 1 ? num_threads - 1 : 0, "combiner")
+{
+    PDEBUG("ChannelCombiner::ChannelCombiner(%zu, %zu, %zu) @ %p\n",
+            sampleRate, offsets.size(), num_threads, this);
+
+    if (offsets.empty()) {
+        throw std::invalid_argument("ChannelCombiner: no channels");
+    }
+
+    for (double offset : offsets) {
+        m_channels.emplace_back(new channel_t(offset, sampleRate));
+    }
+}
+
+std::shared_ptr<ModOutput> ChannelCombiner::input(size_t channel)
+{
+    return std::make_shared<CombinerInput>(m_channels.at(channel)->queue);
+}
+
+void ChannelCombiner::end_of_input(size_t channel)
+{
+    m_channels.at(channel)->queue.push(Buffer::sptr());
+}
+
+void ChannelCombiner::drain()
+{
+    for (auto& ch : m_channels) {
+        while (not ch->ended) {
+            Buffer::sptr frame;
+            ch->queue.wait_and_pop(frame);
+            ch->ended = not frame;
+        }
+    }
+}
+
+int ChannelCombiner::process(Buffer* dataOut)
+{
+    PDEBUG("ChannelCombiner::process(dataOut: %p)\n", dataOut);
+
+    for (auto& ch : m_channels) {
+        if (ch->ended) {
+            return 0;
+        }
+        ch->queue.wait_and_pop(ch->frame);
+        if (not ch->frame) {
+            ch->ended = true;
+            return 0;
+        }
+    }
+
+    const size_t len = m_channels[0]->frame->getLength();
+    for (const auto& ch : m_channels) {
+        if (ch->frame->getLength() != len) {
+            throw std::runtime_error(
+                    "ChannelCombiner: frames of different sizes");
+        }
+    }
+
+    dataOut->setLength(len);
+    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
+    const size_t num_samples = len / sizeof(complexf);
+
+    m_pool.run(num_samples, [&](size_t start, size_t stop) {
+            mix(out, start, stop);
+        }, mix_granularity);
+
+    for (auto& ch : m_channels) {
+        ch->nco.advance(num_samples);
+        ch->frame.reset();
+    }
+
+    return len;
+}
+
+void ChannelCombiner::mix(complexf* out, size_t start, size_t stop)
+{
+    bool first = true;
+    for (const auto& ch : m_channels) {
+        const complexf* in =
+            reinterpret_cast<const complexf*>(ch->frame->getData());
+        ch->nco.mix(in, out, start, stop, not first);
+        first = false;
+    }
+}
+
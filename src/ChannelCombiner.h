@@ -0,0 +1,100 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Combines the signals of several modulators into one wideband signal
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "Nco.h"
+#include "ParallelFor.h"
+#include "SpscQueue.h"
+
+#include <sys/types.h>
+#include <memory>
+#include <vector>
+
+/* The ChannelCombiner takes the baseband signals of several modulators,
+ * all at the same sample rate, shifts each one by the offset of its
+ * channel with a numerically controlled oscillator, and sums them. The
+ * sample rate must be high enough for the channels to fit, e.g.
+ * 16.384 MS/s for blocks up to +-7 MHz from the centre.
+ *
+ * Every modulator runs in its own thread and writes into the combiner
+ * through the ModOutput returned by input(). The combiner is the input
+ * of the flowgraph of the combined output, and its process() waits for
+ * one transmission frame of every channel. The frames of all channels
+ * must have the same size, i.e. the same transmission mode.
+ */
+class ChannelCombiner : public ModInput
+{
+public:
+    /* offsets are in Hz, one per channel. The mixing is spread over
+     * num_threads threads, including the one calling process().
+     */
+    ChannelCombiner(size_t sampleRate,
+            const std::vector<double>& offsets,
+            size_t num_threads);
+    ChannelCombiner(const ChannelCombiner&) = delete;
+    ChannelCombiner& operator=(const ChannelCombiner&) = delete;
+
+    /* The output the modulator of the given channel must use */
+    std::shared_ptr<ModOutput> input(size_t channel);
+
+    /* Must be called by the thread of the modulator of the given channel
+     * once it stopped. The combiner stops at the first ended channel.
+     */
+    void end_of_input(size_t channel);
+
+    /* Discard the frames of all channels until they all ended, to let
+     * the modulators that still push into the combiner stop.
+     */
+    void drain();
+
+    int process(Buffer* dataOut) override;
+    const char* name() override { return "ChannelCombiner"; }
+
+private:
+    struct channel_t {
+        channel_t(double offset, size_t sampleRate);
+
+        SpscQueue<Buffer::sptr> queue;
+        bool ended = false;
+
+        Nco nco;
+
+        // The frame being combined
+        Buffer::sptr frame;
+    };
+
+    void mix(complexf* out, size_t start, size_t stop);
+
+    size_t m_sampleRate;
+    std::vector<std::unique_ptr<channel_t> > m_channels;
+    ParallelFor m_pool;
+};
+
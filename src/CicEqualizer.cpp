@@ -81,12 +81,19 @@ int CicEqualizer::process(Buffer* const dataIn, Buffer* dataOut)
                 "CicEqualizer::process input size not valid!");
     }
 
-    for (size_t i = 0; i < sizeOut; ) {
+    process_symbols(in, out, sizeOut / myNbCarriers);
+
+    return sizeOut;
+}
+
+
+void CicEqualizer::process_symbols(
+        const complexf* in, complexf* out, size_t count) const
+{
+    for (size_t i = 0; i < count * myNbCarriers; ) {
         for (size_t j = 0; j < myNbCarriers; ++j, ++i) {
             out[i] = in[i] * myFilter[j];
         }
     }
-
-    return sizeOut;
 }
 
@@ -50,6 +50,9 @@ public:
     int process(Buffer* const dataIn, Buffer* dataOut);
     const char* name() { return "CicEqualizer"; }
 
+    /* Equalise count symbols of myNbCarriers carriers */
+    void process_symbols(const complexf* in, complexf* out, size_t count) const;
+
 protected:
     size_t myNbCarriers;
     size_t mySpacing;
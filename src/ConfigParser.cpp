@@ -36,6 +36,11 @@
 #include "DabModulator.h"
 
 #include <unistd.h>
+#include <getopt.h>
+#include <sched.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 
@@ -62,94 +67,179 @@ static GainMode parse_gainmode(const std::string &gainMode_setting)
     throw std::runtime_error("Configuration error");
 }
 
-static void parse_configfile(
-        const std::string& configuration_file,
-        mod_settings_t& mod_settings)
+static int parse_sched_policy(const std::string& policy)
 {
-    // First read parameters from the file
-    using boost::property_tree::ptree;
-    ptree pt;
+    if (policy == "other") return SCHED_OTHER;
+    if (policy == "batch") return SCHED_BATCH;
+    if (policy == "idle") return SCHED_IDLE;
+    if (policy == "fifo") return SCHED_FIFO;
+    if (policy == "rr") return SCHED_RR;
 
-    try {
-        read_ini(configuration_file, pt);
-    }
-    catch (boost::property_tree::ini_parser::ini_parser_error &e)
-    {
-        std::cerr << "Error, cannot read configuration file '" << configuration_file.c_str() << "'" << std::endl;
-        std::cerr << "       " << e.what() << std::endl;
-        throw std::runtime_error("Cannot read configuration file");
+    cerr << "Scheduling policy '" << policy << "' not recognised." << endl;
+    throw std::runtime_error("Configuration error");
+}
+
+/* The [threads] section contains entries <name>.cpus, <name>.policy and
+ * <name>.priority, where name is the name of a thread class. */
+static void parse_thread_config(const boost::property_tree::ptree& pt)
+{
+    std::map<std::string, thread_config_t> config;
+
+    const auto threads = pt.get_child_optional("threads");
+    if (not threads) {
+        return;
     }
 
-    // remote controller:
-    if (pt.get("remotecontrol.telnet", 0) == 1) {
+    for (const auto& entry : *threads) {
+        const std::string& key = entry.first;
+        const std::string value = entry.second.data();
+        const size_t dot = key.rfind('.');
+        const std::string name = key.substr(0, dot);
+        const std::string property = (dot == std::string::npos) ?
+            "" : key.substr(dot + 1);
+
         try {
-            int telnetport = pt.get<int>("remotecontrol.telnetport");
-            auto telnetrc = make_shared<RemoteControllerTelnet>(telnetport);
-            rcs.add_controller(telnetrc);
+            if (property == "cpus") {
+                config[name].cpus = parse_cpu_list(value);
+            }
+            else if (property == "policy") {
+                config[name].policy = parse_sched_policy(value);
+            }
+            else if (property == "priority") {
+                config[name].priority = std::stoi(value);
+            }
+            else {
+                cerr << "Unknown setting threads." << key << endl;
+                throw std::runtime_error("Configuration error");
+            }
         }
-        catch (std::exception &e) {
-            std::cerr << "Error: " << e.what() << "\n";
-            std::cerr << "       telnet remote control enabled, but no telnetport defined.\n";
+        catch (const std::logic_error& e) {
+            // Malformed CPU lists and numbers
+            cerr << "Configuration error: invalid value '" << value <<
+                "' for " << key << " in [threads]: " << e.what() << endl;
             throw std::runtime_error("Configuration error");
         }
     }
 
-#if defined(HAVE_ZEROMQ)
-    if (pt.get("remotecontrol.zmqctrl", 0) == 1) {
+    set_thread_config(config);
+
+    // The logger thread runs since startup
+    apply_thread_config("logger", etiLog.io_thread_handle());
+}
+
+/* The [combiner] section contains the entries enabled and threads, and
+ * an entry <name>.offset for every ensemble. */
+static void parse_combiner_config(
+        const boost::property_tree::ptree& pt,
+        mod_settings_t& mod_settings)
+{
+    std::map<std::string, double> offsets;
+
+    for (const auto& entry : pt.get_child("combiner")) {
+        const std::string& key = entry.first;
+        const std::string value = entry.second.data();
+        const size_t dot = key.rfind('.');
+
         try {
-            std::string zmqCtrlEndpoint = pt.get("remotecontrol.zmqctrlendpoint", "");
-            std::cerr << "ZmqCtrlEndpoint: " << zmqCtrlEndpoint << std::endl;
-            auto zmqrc = make_shared<RemoteControllerZmq>(zmqCtrlEndpoint);
-            rcs.add_controller(zmqrc);
+            if (key == "enabled") {
+                continue;
+            }
+            else if (key == "threads") {
+                mod_settings.combinerThreads = std::stoul(value);
+            }
+            else if (dot != std::string::npos and
+                    key.substr(dot + 1) == "offset") {
+                offsets[key.substr(0, dot)] = std::stod(value);
+            }
+            else {
+                cerr << "Unknown setting combiner." << key << endl;
+                throw std::runtime_error("Configuration error");
+            }
         }
-        catch (std::exception &e) {
-            std::cerr << "Error: " << e.what() << "\n";
-            std::cerr << "       zmq remote control enabled, but no endpoint defined.\n";
+        catch (const std::logic_error&) {
+            cerr << "Invalid value '" << value << "' for combiner." <<
+                key << endl;
             throw std::runtime_error("Configuration error");
         }
     }
-#endif
 
-    // input params:
-    if (pt.get("input.loop", 0) == 1) {
-        mod_settings.loop = true;
+    for (const auto& ensemble : mod_settings.ensembles) {
+        const auto offset = offsets.find(ensemble.first);
+        if (offset == offsets.end()) {
+            cerr << "Error: combiner." << ensemble.first <<
+                ".offset not defined" << endl;
+            throw std::runtime_error("Configuration error");
+        }
+        mod_settings.ensembleOffsets.push_back(offset->second);
+        offsets.erase(offset);
     }
 
-    mod_settings.inputTransport = pt.get("input.transport", "file");
-    mod_settings.inputMaxFramesQueued = pt.get("input.max_frames_queued",
-            ZMQ_INPUT_MAX_FRAME_QUEUE);
+    if (not offsets.empty()) {
+        cerr << "Error: combiner." << offsets.begin()->first <<
+            ".offset given for an unknown ensemble" << endl;
+        throw std::runtime_error("Configuration error");
+    }
 
-    mod_settings.edi_max_delay_ms = pt.get("input.edi_max_delay", 0.0f);
+    mod_settings.combineEnsembles = true;
+}
 
-    mod_settings.inputName = pt.get("input.source", "/dev/stdin");
+/* The default watermarks follow max_frames_queued, so that configuration
+ * files written before the jitter buffer existed keep working. If the
+ * queue is too short for a high watermark, the frames are never dropped.
+ */
+static void parse_jitter_buffer_settings(
+        const boost::property_tree::ptree& pt,
+        mod_settings_t& mod_settings)
+{
+    const size_t max_queued = mod_settings.inputMaxFramesQueued;
 
-    // log parameters:
-    if (pt.get("log.syslog", 0) == 1) {
-        LogToSyslog* log_syslog = new LogToSyslog();
-        etiLog.register_backend(log_syslog);
-    }
+    mod_settings.inputJitterLow = pt.get("input.jitter_low",
+            std::min<size_t>(10, std::max<size_t>(1, max_queued / 4)));
 
-    if (pt.get("log.filelog", 0) == 1) {
-        std::string logfilename;
-        try {
-            logfilename = pt.get<std::string>("log.filename");
-        }
-        catch (std::exception &e) {
-            std::cerr << "Error: " << e.what() << "\n";
-            std::cerr << "       Configuration enables file log, but does not specify log filename\n";
-            throw std::runtime_error("Configuration error");
+    const auto high = pt.get_optional<size_t>("input.jitter_high");
+    if (high) {
+        mod_settings.inputJitterHigh = *high;
+    }
+    else {
+        mod_settings.inputJitterHigh = 3 * max_queued / 4;
+        if (mod_settings.inputJitterHigh <= mod_settings.inputJitterLow + 4) {
+            mod_settings.inputJitterHigh = 0;
         }
+    }
 
-        LogToFile* log_file = new LogToFile(logfilename);
-        etiLog.register_backend(log_file);
+    if (mod_settings.inputJitterLow == 0) {
+        std::cerr << "Configuration error: input.jitter_low must be "
+            "at least 1" << endl;
+        throw std::runtime_error("Configuration error");
     }
 
-    auto trace_filename = pt.get<std::string>("log.trace", "");
-    if (not trace_filename.empty()) {
-        LogTracer* tracer = new LogTracer(trace_filename);
-        etiLog.register_backend(tracer);
+    if (mod_settings.inputJitterHigh != 0 and
+            (mod_settings.inputJitterHigh <= mod_settings.inputJitterLow + 4 or
+             mod_settings.inputJitterHigh >= max_queued)) {
+        std::cerr << "Configuration error: input.jitter_high must be " <<
+            "larger than jitter_low + 4 and smaller than " <<
+            "max_frames_queued, or 0 to disable the dropping" << endl;
+        throw std::runtime_error("Configuration error");
     }
+}
+
+static void parse_modulator_settings(
+        const boost::property_tree::ptree& pt,
+        mod_settings_t& mod_settings)
+{
+    // input params:
+    if (pt.get("input.loop", 0) == 1) {
+        mod_settings.loop = true;
+    }
+
+    mod_settings.inputTransport = pt.get("input.transport", "file");
+    mod_settings.inputMaxFramesQueued = pt.get("input.max_frames_queued",
+            ZMQ_INPUT_MAX_FRAME_QUEUE);
+    parse_jitter_buffer_settings(pt, mod_settings);
+
+    mod_settings.edi_max_delay_ms = pt.get("input.edi_max_delay", 0.0f);
 
+    mod_settings.inputName = pt.get("input.source", "/dev/stdin");
 
     // modulator parameters:
     const string gainMode_setting = pt.get("modulator.gainmode", "var");
@@ -161,6 +251,14 @@ static void parse_configfile(
     mod_settings.clockRate = pt.get("modulator.dac_clk_rate", (size_t)0);
     mod_settings.digitalgain = pt.get("modulator.digital_gain", mod_settings.digitalgain);
     mod_settings.outputRate = pt.get("modulator.rate", mod_settings.outputRate);
+    mod_settings.fftwWisdomFilename = pt.get("modulator.fftw_wisdom",
+            mod_settings.fftwWisdomFilename);
+    mod_settings.streamSymbols = pt.get("modulator.stream_symbols",
+            mod_settings.streamSymbols);
+    mod_settings.parallelFrames = pt.get("modulator.parallel_frames",
+            mod_settings.parallelFrames);
+    mod_settings.encoderCacheSize = pt.get("modulator.encoder_cache",
+            mod_settings.encoderCacheSize);
 
     // FIR Filter parameters:
     if (pt.get("firfilter.enabled", 0) == 1) {
@@ -184,6 +282,12 @@ static void parse_configfile(
         mod_settings.cfrErrorClip = pt.get<float>("cfr.error_clip");
     }
 
+    // Digital frequency shift
+    if (pt.get("freqshift.enabled", 0) == 1) {
+        mod_settings.enableFreqShift = true;
+        mod_settings.freqShiftOffset = pt.get("freqshift.offset", 0.0);
+    }
+
     // Output options
     std::string output_selected;
     try {
@@ -342,6 +446,125 @@ static void parse_configfile(
 }
 
 
+static boost::property_tree::ptree read_configfile(
+        const std::string& configuration_file)
+{
+    boost::property_tree::ptree pt;
+
+    try {
+        read_ini(configuration_file, pt);
+    }
+    catch (boost::property_tree::ini_parser::ini_parser_error &e)
+    {
+        std::cerr << "Error, cannot read configuration file '" << configuration_file.c_str() << "'" << std::endl;
+        std::cerr << "       " << e.what() << std::endl;
+        throw std::runtime_error("Cannot read configuration file");
+    }
+
+    return pt;
+}
+
+static void parse_configfile(
+        const std::string& configuration_file,
+        mod_settings_t& mod_settings)
+{
+    // First read parameters from the file
+    const auto pt = read_configfile(configuration_file);
+
+    // Before any thread other than the logger gets started
+    parse_thread_config(pt);
+
+    // remote controller:
+    if (pt.get("remotecontrol.telnet", 0) == 1) {
+        try {
+            int telnetport = pt.get<int>("remotecontrol.telnetport");
+            auto telnetrc = make_shared<RemoteControllerTelnet>(telnetport);
+            rcs.add_controller(telnetrc);
+        }
+        catch (std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            std::cerr << "       telnet remote control enabled, but no telnetport defined.\n";
+            throw std::runtime_error("Configuration error");
+        }
+    }
+
+#if defined(HAVE_ZEROMQ)
+    if (pt.get("remotecontrol.zmqctrl", 0) == 1) {
+        try {
+            std::string zmqCtrlEndpoint = pt.get("remotecontrol.zmqctrlendpoint", "");
+            std::cerr << "ZmqCtrlEndpoint: " << zmqCtrlEndpoint << std::endl;
+            auto zmqrc = make_shared<RemoteControllerZmq>(zmqCtrlEndpoint);
+            rcs.add_controller(zmqrc);
+        }
+        catch (std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            std::cerr << "       zmq remote control enabled, but no endpoint defined.\n";
+            throw std::runtime_error("Configuration error");
+        }
+    }
+#endif
+
+    // log parameters:
+    if (pt.get("log.syslog", 0) == 1) {
+        LogToSyslog* log_syslog = new LogToSyslog();
+        etiLog.register_backend(log_syslog);
+    }
+
+    if (pt.get("log.filelog", 0) == 1) {
+        std::string logfilename;
+        try {
+            logfilename = pt.get<std::string>("log.filename");
+        }
+        catch (std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            std::cerr << "       Configuration enables file log, but does not specify log filename\n";
+            throw std::runtime_error("Configuration error");
+        }
+
+        LogToFile* log_file = new LogToFile(logfilename);
+        etiLog.register_backend(log_file);
+    }
+
+    auto trace_filename = pt.get<std::string>("log.trace", "");
+    if (not trace_filename.empty()) {
+        LogTracer* tracer = new LogTracer(trace_filename);
+        etiLog.register_backend(tracer);
+    }
+
+
+    // Several modulators in one process, each configured by its own file
+    if (auto ensembles = pt.get_child_optional("ensembles")) {
+        for (const auto& ensemble : *ensembles) {
+            mod_settings.ensembles.emplace_back(
+                    ensemble.first, ensemble.second.data());
+        }
+    }
+
+    if (not mod_settings.ensembles.empty()) {
+        // The other sections are in the configuration of each ensemble
+        mod_settings.fftwWisdomFilename = pt.get("modulator.fftw_wisdom",
+                mod_settings.fftwWisdomFilename);
+
+        // Only the output section applies to the combined ensembles
+        if (pt.get("combiner.enabled", 0) == 1) {
+            parse_combiner_config(pt, mod_settings);
+            parse_modulator_settings(pt, mod_settings);
+        }
+        return;
+    }
+
+    parse_modulator_settings(pt, mod_settings);
+}
+
+void parse_ensemble_configfile(
+        const std::string& configuration_file,
+        mod_settings_t& mod_settings)
+{
+    const auto pt = read_configfile(configuration_file);
+    parse_modulator_settings(pt, mod_settings);
+}
+
+
 void parse_args(int argc, char **argv, mod_settings_t& mod_settings)
 {
     bool use_configuration_cmdline = false;
@@ -354,13 +577,19 @@ void parse_args(int argc, char **argv, mod_settings_t& mod_settings)
         throw std::invalid_argument("Invalid command line options");
     }
 
+    const struct option longopts[] = {
+        {"plan-wisdom", no_argument, nullptr, 'P'},
+        {"batch", optional_argument, nullptr, 'B'},
+        {nullptr, 0, nullptr, 0} };
+
     while (true) {
-        int c = getopt(argc, argv, "a:C:c:f:F:g:G:hlm:o:O:r:T:u:V");
+        int c = getopt_long(argc, argv, "a:C:c:f:F:g:G:hlm:o:O:r:T:u:VW:",
+                longopts, nullptr);
         if (c == -1) {
             break;
         }
 
-        if (c != 'C') {
+        if (c != 'C' and c != 'P' and c != 'B') {
             use_configuration_cmdline = true;
         }
 
@@ -430,6 +659,18 @@ void parse_args(int argc, char **argv, mod_settings_t& mod_settings)
             mod_settings.useUHDOutput = 1;
 #endif
             break;
+        case 'P':
+            mod_settings.planWisdom = true;
+            break;
+        case 'B':
+            mod_settings.batchMode = true;
+            if (optarg) {
+                mod_settings.batchWorkers = strtoul(optarg, NULL, 0);
+            }
+            break;
+        case 'W':
+            mod_settings.fftwWisdomFilename = optarg;
+            break;
         case 'V':
             printVersion();
             throw std::invalid_argument("");
@@ -450,6 +691,12 @@ void parse_args(int argc, char **argv, mod_settings_t& mod_settings)
         use_configuration_file = true;
         configuration_file = argv[1];
     }
+    else if ((mod_settings.planWisdom or mod_settings.batchMode) and
+            not use_configuration_cmdline and
+            not use_configuration_file and optind == argc - 1) {
+        use_configuration_file = true;
+        configuration_file = argv[optind++];
+    }
 
     if (use_configuration_file && use_configuration_cmdline) {
         fprintf(stderr, "Warning: configuration file and command "
@@ -31,7 +31,10 @@
 #   include "config.h"
 #endif
 
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "GainControl.h"
 #include "TII.h"
 #if defined(HAVE_OUTPUT_UHD)
@@ -43,6 +46,9 @@
 
 #define ZMQ_INPUT_MAX_FRAME_QUEUE 500
 
+class ParallelFor;
+class LanePool;
+
 struct mod_settings_t {
     std::string outputName;
     int useZeroMQOutput = 0;
@@ -68,6 +74,10 @@ struct mod_settings_t {
     std::string inputName = "";
     std::string inputTransport = "file";
     unsigned inputMaxFramesQueued = ZMQ_INPUT_MAX_FRAME_QUEUE;
+    // Watermarks of the jitter buffer of the ZeroMQ and EDI inputs, in
+    // ETI frames. A high watermark of 0 disables the dropping.
+    size_t inputJitterLow = 10;
+    size_t inputJitterHigh = 3 * ZMQ_INPUT_MAX_FRAME_QUEUE / 4;
     float edi_max_delay_ms = 0.0f;
 
     tii_config_t tiiConfig;
@@ -77,11 +87,53 @@ struct mod_settings_t {
     std::string polyCoefFilename = "";
     unsigned polyNumThreads = 0;
 
+    // FFTW wisdom is loaded from and saved to this file, if not empty
+    std::string fftwWisdomFilename = "";
+    // Only plan the FFTs, save the wisdom and exit
+    bool planWisdom = false;
+
+    // Modulate the input file as fast as possible with several modulators,
+    // 0 workers uses one per CPU
+    bool batchMode = false;
+    unsigned batchWorkers = 0;
+
+    // Name and configuration file of each modulator, when several run
+    // in this process. The remote control names of their blocks are
+    // prefixed with the name.
+    std::vector<std::pair<std::string, std::string> > ensembles;
+
+    // Mix the ensembles into the output of the host configuration, each
+    // shifted by its offset in Hz. The mixing uses combinerThreads threads.
+    bool combineEnsembles = false;
+    std::vector<double> ensembleOffsets;
+    unsigned combinerThreads = 1;
+
+    // Worker pools shared by the modulators of all ensembles, set by the
+    // host. When empty, each modulator creates its own.
+    std::shared_ptr<ParallelFor> sharedDspPool;
+    std::shared_ptr<LanePool> sharedLanePool;
+
+    // Number of symbols processed together by the OFDM back-end,
+    // 0 processes whole transmission frames
+    size_t streamSymbols = 0;
+
+    // Number of transmission frames the OFDM back-end processes
+    // concurrently, 0 or 1 processes them one after the other
+    unsigned parallelFrames = 0;
+
+    // Number of frames of the channel coding kept in the encoder cache,
+    // 0 disables the cache
+    size_t encoderCacheSize = 0;
+
     // Settings for crest factor reduction
     bool enableCfr = false;
     float cfrClip = 1.0f;
     float cfrErrorClip = 1.0f;
 
+    // Shift of the output signal in Hz
+    bool enableFreqShift = false;
+    double freqShiftOffset = 0.0;
+
 
 #if defined(HAVE_OUTPUT_UHD)
     OutputUHDConfig outputuhd_conf;
@@ -95,3 +147,9 @@ struct mod_settings_t {
 
 void parse_args(int argc, char **argv, mod_settings_t& mod_settings);
 
+// Read the settings of one of several modulators, ignoring the log,
+// remote control and thread configuration
+void parse_ensemble_configfile(
+        const std::string& configuration_file,
+        mod_settings_t& mod_settings);
+
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdexcept>
+#include <vector>
 
 
 const static uint8_t PARITY[] = {
@@ -47,11 +48,55 @@ const static uint8_t PARITY[] = {
 };
 
 
+/* Build the table of output bits indexed by the 6-bit encoder state and
+ * the input byte, by running the bit-serial encoder over every entry.
+ */
+static std::vector<uint32_t> build_table()
+{
+    std::vector<uint32_t> table(64 * 256);
+
+    for (uint16_t state = 0; state < 64; ++state) {
+        for (uint16_t byte = 0; byte < 256; ++byte) {
+            // Shift the six state bits into the memory, oldest first
+            uint16_t memory = 0;
+            for (int j = 5; j >= 0; --j) {
+                memory >>= 1;
+                memory |= ((state >> j) & 1) << 6;
+            }
+
+            uint8_t data = byte;
+            uint32_t out = 0;
+            for (unsigned j = 0; j < 8; ++j) {
+                memory >>= 1;
+                memory |= (data >> 7) << 6;
+                data <<= 1;
+                uint8_t poly[4] = {
+                    (uint8_t)(memory & 0x5b),
+                    (uint8_t)(memory & 0x79),
+                    (uint8_t)(memory & 0x65),
+                    (uint8_t)(memory & 0x5b)
+                };
+                for (unsigned k = 0; k < 4; ++k) {
+                    out <<= 1;
+                    out |= PARITY[poly[k]];
+                }
+            }
+            table[(state << 8) | byte] = out;
+        }
+    }
+
+    return table;
+}
+
+
 ConvEncoder::ConvEncoder(size_t framesize) :
     ModCodec(),
     d_framesize(framesize)
 {
     PDEBUG("ConvEncoder::ConvEncoder(%zu)\n", framesize);
+
+    static const std::vector<uint32_t> table = build_table();
+    d_table = table.data();
 }
 
 
@@ -63,10 +108,6 @@ int ConvEncoder::process(Buffer* const dataIn, Buffer* dataOut)
 
     size_t in_block_size = d_framesize;
     size_t out_block_size = (d_framesize * 4) + 3;
-    size_t in_offset = 0;
-    size_t out_offset = 0;
-    uint16_t memory = 0;
-    uint8_t data;
 
     if (dataIn->getLength() != in_block_size) {
         PDEBUG("%zu != %zu != 0\n", dataIn->getLength(), in_block_size);
@@ -77,73 +118,22 @@ int ConvEncoder::process(Buffer* const dataIn, Buffer* dataOut)
     const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
     uint8_t* out = reinterpret_cast<uint8_t*>(dataOut->getData());
 
-    // While there is enought input and ouput items
-    while (dataIn->getLength() - in_offset >= in_block_size &&
-            dataOut->getLength() - out_offset >= out_block_size) {
-        for (size_t in_count = 0; in_count < in_block_size; ++in_count) {
-            data = in[in_offset];
-            //PDEBUG("Input: 0x%x\n", data);
-            // For next 4 output bytes
-            for (unsigned out_count = 0; out_count < 4; ++out_count) {
-                out[out_offset] = 0;
-                // For each 4-bit output word
-                for (unsigned j = 0; j < 2; ++j) {
-                    memory >>= 1;
-                    memory |= (data >> 7) << 6;
-                    data <<= 1;
-                    //PDEBUG("Memory: 0x%x\n", memory);
-                    uint8_t poly[4] = {
-                        (uint8_t)(memory & 0x5b),
-                        (uint8_t)(memory & 0x79),
-                        (uint8_t)(memory & 0x65),
-                        (uint8_t)(memory & 0x5b)
-                    };
-                    //PDEBUG("Polys: 0x%x, 0x%x, 0x%x, 0x%x\n", poly[0], poly[1], poly[2], poly[3]);
-                    // For each poly
-                    for (unsigned k = 0; k < 4; ++k) {
-                        out[out_offset] <<= 1;
-                        out[out_offset] |= PARITY[poly[k]];
-                        //PDEBUG("Out bit: %i\n", out[no] >> 7);
-                    }
-                }
-                //PDEBUG("Out: 0x%x\n", out[no]);
-                ++out_offset;
-            }
-            ++in_offset;
-        }
-
-        for (unsigned pad_count = 0; pad_count < 3; ++pad_count) {
-            out[out_offset] = 0;
-            // For each 4-bit output word
-            for (unsigned j = 0; j < 2; ++j) {
-                memory >>= 1;
-                //PDEBUG("Memory: 0x%x\n", memory);
-                uint8_t poly[4] = {
-                    (uint8_t)(memory & 0x5b),
-                    (uint8_t)(memory & 0x79),
-                    (uint8_t)(memory & 0x65),
-                    (uint8_t)(memory & 0x5b)
-                };
-                //PDEBUG("Polys: 0x%x, 0x%x, 0x%x, 0x%x\n", poly[0], poly[1], poly[2], poly[3]);
-                // For each poly
-                for (unsigned k = 0; k < 4; ++k) {
-                    out[out_offset] <<= 1;
-                    out[out_offset] |= PARITY[poly[k]];
-                    //PDEBUG("Out bit: %i\n", out[no] >> 7);
-                }
-            }
-            //PDEBUG("Out: 0x%x\n", out[no]);
-            ++out_offset;
-        }
+    uint8_t previous = 0;
+    for (size_t i = 0; i < in_block_size; ++i) {
+        const uint32_t bits = encode_byte(previous, in[i]);
+        out[0] = bits >> 24;
+        out[1] = bits >> 16;
+        out[2] = bits >> 8;
+        out[3] = bits;
+        out += 4;
+        previous = in[i];
     }
 
-    PDEBUG(" Consume: %zu\n", in_offset);
-    PDEBUG(" Return: %zu\n", out_offset);
+    // Flush the encoder memory with six zero bits, giving 24 tail bits
+    const uint32_t tail = encode_byte(previous, 0);
+    out[0] = tail >> 24;
+    out[1] = tail >> 16;
+    out[2] = tail >> 8;
 
-    if (out_offset != dataOut->getLength()) {
-        throw std::runtime_error("Assertion error: ConvEncoder output " +
-                std::to_string(out_offset) + " == " +
-                std::to_string(dataOut->getLength()) + " fail");
-    }
-    return out_offset;
+    return out_block_size;
 }
@@ -27,7 +27,14 @@
 
 #include "ModPlugin.h"
 #include <sys/types.h>
+#include <stdint.h>
 
+/* Convolutional encoder of EN 300 401 Clause 11.1.
+ *
+ * The encoder is table-driven and processes one input byte at a time. As
+ * the encoder memory holds the six previous input bits, the state before
+ * a byte is given by the six least significant bits of the byte before.
+ */
 class ConvEncoder : public ModCodec
 {
 public:
@@ -35,7 +42,17 @@ public:
     int process(Buffer* const dataIn, Buffer* dataOut);
     const char* name() { return "ConvEncoder"; }
 
+    /* Return the 32 output bits for the input byte data, the first output
+     * bit in the MSB. previous is the input byte before data, or 0 at the
+     * start of the frame.
+     */
+    uint32_t encode_byte(uint8_t previous, uint8_t data) const {
+        return d_table[((previous & 0x3f) << 8) | data];
+    }
+
 private:
     size_t d_framesize;
-};
 
+    // Output bits for every (state, byte) pair, shared by all instances
+    const uint32_t* d_table;
+};
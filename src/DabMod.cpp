@@ -49,10 +49,19 @@
 #include "FIRFilter.h"
 #include "RemoteControl.h"
 #include "ConfigParser.h"
-
+#include "FftwWisdom.h"
+#include "BatchModulator.h"
+#include "ChannelCombiner.h"
+#include "FrameParallel.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <complex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/types.h>
@@ -179,31 +188,36 @@ static void printModSettings(const mod_settings_t& mod_settings)
     }
 }
 
+static void set_file_output_normalise(mod_settings_t& s)
+{
+    if (s.fileOutputFormat == "complexf_normalised") {
+        if (s.gainMode == GainMode::GAIN_FIX)
+            s.normalise = 1.0f / normalise_factor_file_fix;
+        else if (s.gainMode == GainMode::GAIN_MAX)
+            s.normalise = 1.0f / normalise_factor_file_max;
+        else if (s.gainMode == GainMode::GAIN_VAR)
+            s.normalise = 1.0f / normalise_factor_file_var;
+    }
+    else if (s.fileOutputFormat == "s8" or
+            s.fileOutputFormat == "u8") {
+        // We must normalise the samples to the interval [-127.0; 127.0]
+        // The formatconverter will add 127 for u8 so that it ends up in
+        // [0; 255]
+        s.normalise = 127.0f / normalise_factor;
+    }
+}
+
 static shared_ptr<ModOutput> prepare_output(
         mod_settings_t& s)
 {
     shared_ptr<ModOutput> output;
 
     if (s.useFileOutput) {
-        if (s.fileOutputFormat == "complexf") {
-            output = make_shared<OutputFile>(s.outputName);
-        }
-        if (s.fileOutputFormat == "complexf_normalised") {
-            if (s.gainMode == GainMode::GAIN_FIX)
-                s.normalise = 1.0f / normalise_factor_file_fix;
-            else if (s.gainMode == GainMode::GAIN_MAX)
-                s.normalise = 1.0f / normalise_factor_file_max;
-            else if (s.gainMode == GainMode::GAIN_VAR)
-                s.normalise = 1.0f / normalise_factor_file_var;
-            output = make_shared<OutputFile>(s.outputName);
-        }
-        else if (s.fileOutputFormat == "s8" or
+        set_file_output_normalise(s);
+        if (s.fileOutputFormat == "complexf" or
+                s.fileOutputFormat == "complexf_normalised" or
+                s.fileOutputFormat == "s8" or
                 s.fileOutputFormat == "u8") {
-            // We must normalise the samples to the interval [-127.0; 127.0]
-            // The formatconverter will add 127 for u8 so that it ends up in
-            // [0; 255]
-            s.normalise = 127.0f / normalise_factor;
-
             output = make_shared<OutputFile>(s.outputName);
         }
     }
@@ -245,10 +259,12 @@ static shared_ptr<ModOutput> prepare_output(
     return output;
 }
 
+static int modulate(mod_settings_t& mod_settings,
+        shared_ptr<ModOutput> output = nullptr);
+static int launch_ensembles(const mod_settings_t& host_settings);
+
 int launch_modulator(int argc, char* argv[])
 {
-    int ret = 0;
-
     struct sigaction sa;
     memset(&sa, 0, sizeof(struct sigaction));
     sa.sa_handler = &signalHandler;
@@ -263,7 +279,254 @@ int launch_modulator(int argc, char* argv[])
 
     printStartupInfo();
 
-    if (not (mod_settings.useFileOutput or
+    if (not mod_settings.fftwWisdomFilename.empty()) {
+        fftw_wisdom_load(mod_settings.fftwWisdomFilename);
+    }
+
+    if (mod_settings.planWisdom) {
+        fftw_plan_wisdom(mod_settings);
+        return EXIT_SUCCESS;
+    }
+
+    if (not mod_settings.ensembles.empty()) {
+        return launch_ensembles(mod_settings);
+    }
+
+    return modulate(mod_settings);
+}
+
+/* Prepare the settings of the ensembles for their combination into the
+ * output configured in the host settings, and create the combiner.
+ */
+static shared_ptr<ChannelCombiner> prepare_combiner(
+        const mod_settings_t& host_settings,
+        vector<mod_settings_t>& settings)
+{
+    if (host_settings.useUHDOutput or host_settings.useSoapyOutput) {
+        // These outputs take the timestamps from the ETI source
+        throw std::invalid_argument(
+                "The combined ensembles can only be written to a file "
+                "or a ZeroMQ output");
+    }
+
+    const size_t sampleRate = settings[0].outputRate;
+    for (const auto& s : settings) {
+        if (s.outputRate != sampleRate) {
+            throw std::invalid_argument(
+                    "The combined ensembles must have the same rate");
+        }
+    }
+
+    const auto& offsets = host_settings.ensembleOffsets;
+    for (size_t i = 0; i < offsets.size(); i++) {
+        // The ensemble occupies 1.536 MHz around its offset
+        if (std::fabs(offsets[i]) + 768000.0 > sampleRate / 2.0) {
+            etiLog.level(warn) << "Ensemble " <<
+                host_settings.ensembles[i].first <<
+                " does not fit into the band of the combined output";
+        }
+    }
+
+    /* Every ensemble is normalised for the combined output, and scaled
+     * down so that their sum stays in the range of the output.
+     */
+    for (auto& s : settings) {
+        s.useFileOutput = host_settings.useFileOutput;
+        s.fileOutputFormat = host_settings.fileOutputFormat;
+        if (s.useFileOutput) {
+            set_file_output_normalise(s);
+        }
+        else {
+            s.normalise = 1.0f / normalise_factor;
+        }
+        s.normalise /= settings.size();
+
+        s.useFileOutput = false;
+        s.useUHDOutput = false;
+        s.useSoapyOutput = false;
+        s.useZeroMQOutput = false;
+    }
+
+    return make_shared<ChannelCombiner>(sampleRate, offsets,
+            host_settings.combinerThreads);
+}
+
+/* Write the combined ensembles to the output, until one of them stops */
+static void run_combiner(mod_settings_t s,
+        shared_ptr<ChannelCombiner> combiner)
+{
+    set_thread_name("combiner");
+
+    shared_ptr<FormatConverter> format_converter;
+    if (s.useFileOutput and
+            (s.fileOutputFormat == "s8" or
+             s.fileOutputFormat == "u8")) {
+        format_converter = make_shared<FormatConverter>(s.fileOutputFormat);
+    }
+
+    auto output = prepare_output(s);
+
+    Flowgraph flowgraph;
+    if (format_converter) {
+        flowgraph.connect(combiner, format_converter);
+        flowgraph.connect(format_converter, output);
+    }
+    else {
+        flowgraph.connect(combiner, output);
+    }
+
+    size_t framecount = 0;
+    while (running and flowgraph.run()) {
+        framecount++;
+    }
+
+    etiLog.level(info) << framecount <<
+        " transmission frames of the combined ensembles written";
+}
+
+/* Run several modulators, each in its own thread. They share the logger,
+ * the remote control, the thread configuration and the FFTW wisdom of the
+ * host configuration, and the precomputed tables of the blocks.
+ *
+ * They also share the worker pools: one ParallelFor for the FIR filters
+ * and predistorters, and one LanePool for the frame-parallel back-ends,
+ * so that the number of DSP threads does not grow with the number of
+ * ensembles.
+ *
+ * When they are combined, this thread mixes their outputs into the output
+ * of the host configuration.
+ */
+static int launch_ensembles(const mod_settings_t& host_settings)
+{
+    if (host_settings.batchMode) {
+        throw std::invalid_argument(
+                "Batch mode is not available with several ensembles");
+    }
+
+    vector<mod_settings_t> settings;
+    for (const auto& ensemble : host_settings.ensembles) {
+        mod_settings_t s;
+        s.fftwWisdomFilename = host_settings.fftwWisdomFilename;
+        parse_ensemble_configfile(ensemble.second, s);
+        settings.push_back(s);
+    }
+
+    const unsigned int hw_concurrency =
+        std::max(std::thread::hardware_concurrency(), 1u);
+
+    bool need_dsp_pool = false;
+    unsigned int dsp_workers = 0;
+    size_t max_lanes = 0;
+    size_t total_lanes = 0;
+    for (const auto& s : settings) {
+        if (not s.filterTapsFilename.empty() or
+                not s.polyCoefFilename.empty()) {
+            need_dsp_pool = true;
+        }
+        dsp_workers = std::max(dsp_workers, s.polyNumThreads);
+        if (s.parallelFrames > 1) {
+            max_lanes = std::max<size_t>(max_lanes, s.parallelFrames);
+            total_lanes += s.parallelFrames;
+        }
+    }
+
+    shared_ptr<ParallelFor> dsp_pool;
+    if (need_dsp_pool) {
+        // The runs of the pipeline threads take turns on the workers. The
+        // largest poly.num_threads of the ensembles sizes the pool.
+        dsp_pool = make_shared<ParallelFor>(
+                dsp_workers ? dsp_workers : hw_concurrency - 1, "dsp");
+        etiLog.level(info) << "The ensembles share " <<
+            dsp_pool->concurrency() << " DSP threads";
+    }
+
+    shared_ptr<LanePool> lane_pool;
+    if (max_lanes > 0) {
+        // Enough threads for the largest back-end, more up to one per CPU
+        // when several ensembles run frame-parallel
+        const size_t num_threads = std::max(max_lanes,
+                std::min<size_t>(total_lanes, hw_concurrency));
+        lane_pool = make_shared<LanePool>(num_threads);
+        etiLog.level(info) << "The ensembles share " <<
+            num_threads << " frame-parallel lanes";
+    }
+
+    for (auto& s : settings) {
+        s.sharedDspPool = dsp_pool;
+        s.sharedLanePool = lane_pool;
+    }
+
+    shared_ptr<ChannelCombiner> combiner;
+    if (host_settings.combineEnsembles) {
+        combiner = prepare_combiner(host_settings, settings);
+    }
+
+    vector<int> rets(settings.size(), 0);
+    vector<thread> threads;
+
+    for (size_t i = 0; i < settings.size(); i++) {
+        const string& name = host_settings.ensembles[i].first;
+        etiLog.level(info) << "Starting modulator for ensemble " << name;
+
+        threads.emplace_back([&, i, name]() {
+                RemoteControllers::set_thread_namespace(name);
+                try {
+                    if (combiner) {
+                        rets[i] = modulate(settings[i], combiner->input(i));
+                    }
+                    else {
+                        rets[i] = modulate(settings[i]);
+                    }
+                }
+                catch (std::exception& e) {
+                    etiLog.level(error) << "Ensemble " << name << ": " <<
+                        e.what();
+                    rets[i] = 1;
+                }
+                if (combiner) {
+                    combiner->end_of_input(i);
+                }
+                etiLog.level(info) << "Ensemble " << name << " stopped";
+            });
+    }
+
+    int ret = 0;
+
+    if (combiner) {
+        try {
+            run_combiner(host_settings, combiner);
+        }
+        catch (std::exception& e) {
+            etiLog.level(error) << "Combiner: " << e.what();
+            ret = 1;
+        }
+
+        // Stop the other ensembles once one of them stopped
+        running = 0;
+        combiner->drain();
+    }
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+        if (rets[i] != 0) {
+            ret = rets[i];
+        }
+    }
+
+    etiLog.level(info) << "Terminating";
+    return ret;
+}
+
+/* Modulate the input configured in mod_settings. The output is the one
+ * configured in mod_settings, unless another one is given.
+ */
+static int modulate(mod_settings_t& mod_settings,
+        shared_ptr<ModOutput> output)
+{
+    int ret = 0;
+
+    if (not output and
+        not (mod_settings.useFileOutput or
              mod_settings.useUHDOutput or
              mod_settings.useZeroMQOutput or
              mod_settings.useSoapyOutput)) {
@@ -278,18 +541,42 @@ int launch_modulator(int argc, char* argv[])
         mod_settings.tist_delay_stages += FIRFILTER_PIPELINE_DELAY;
     }
 
+    // The streaming and frame-parallel back-ends replace the pipelined
+    // GainControl, the latter delays by one frame per additional lane
+    if (mod_settings.streamSymbols > 0 or mod_settings.parallelFrames > 1) {
+        mod_settings.tist_delay_stages -= 1;
+    }
+    if (mod_settings.parallelFrames > 1) {
+        mod_settings.tist_delay_stages += mod_settings.parallelFrames - 1;
+    }
+
     printModSettings(mod_settings);
 
+    if (mod_settings.batchMode) {
+        // Offline modulation, the pipelined blocks and the lanes of the
+        // workers must not run with realtime priority either
+        disable_realtime_prio();
+        set_file_output_normalise(mod_settings);
+        BatchModulator batch(mod_settings, mod_settings.batchWorkers);
+        const size_t framecount = batch.run(running);
+        etiLog.level(info) << framecount << " DAB frames encoded";
+        etiLog.level(info) << ((float)framecount * 0.024f) << " seconds encoded";
+        etiLog.level(info) << "Terminating";
+        return EXIT_SUCCESS;
+    }
+
     modulator_data m;
 
     shared_ptr<FormatConverter> format_converter;
-    if (mod_settings.useFileOutput and
+    if (not output and mod_settings.useFileOutput and
             (mod_settings.fileOutputFormat == "s8" or
              mod_settings.fileOutputFormat == "u8")) {
         format_converter = make_shared<FormatConverter>(mod_settings.fileOutputFormat);
     }
 
-    auto output = prepare_output(mod_settings);
+    if (not output) {
+        output = prepare_output(mod_settings);
+    }
 
     // Set thread priority to realtime
     if (int r = set_realtime_prio(1)) {
@@ -306,7 +593,8 @@ int launch_modulator(int argc, char* argv[])
         }
         EdiUdpInput ediUdpInput(ediInput);
 
-        ediUdpInput.Open(mod_settings.inputName);
+        ediUdpInput.Open(mod_settings.inputName,
+                mod_settings.inputJitterLow, mod_settings.inputJitterHigh);
         if (not ediUdpInput.isEnabled()) {
             etiLog.level(error) << "inputTransport is edi, but ediUdpInput is not enabled";
             return -1;
@@ -335,17 +623,20 @@ int launch_modulator(int argc, char* argv[])
 #endif
 
         size_t framecount = 0;
+        bool input_ok = true;
 
-        while (running) {
+        while (running and input_ok) {
             while (not ediReader.isFrameReady()) {
                 bool success = ediUdpInput.rxPacket();
                 if (not success) {
-                    running = false;
+                    input_ok = false;
                     break;
                 }
             }
             framecount++;
-            flowgraph.run();
+            if (not ediUdpInput.dropFrame(ediReader.getFp())) {
+                flowgraph.run();
+            }
             ediReader.clearFrame();
 
             /* Check every once in a while if the remote control
@@ -378,7 +669,9 @@ int launch_modulator(int argc, char* argv[])
             throw std::runtime_error("Unable to open input");
 #else
             auto inputZeroMQReader = make_shared<InputZeroMQReader>();
-            inputZeroMQReader->Open(mod_settings.inputName, mod_settings.inputMaxFramesQueued);
+            inputZeroMQReader->Open(mod_settings.inputName,
+                    mod_settings.inputMaxFramesQueued,
+                    mod_settings.inputJitterLow, mod_settings.inputJitterHigh);
             inputReader = inputZeroMQReader;
 #endif
         }
@@ -456,7 +749,10 @@ int launch_modulator(int argc, char* argv[])
                         run_again = true;
                         // Create a new input reader
                         auto inputZeroMQReader = make_shared<InputZeroMQReader>();
-                        inputZeroMQReader->Open(mod_settings.inputName, mod_settings.inputMaxFramesQueued);
+                        inputZeroMQReader->Open(mod_settings.inputName,
+                                mod_settings.inputMaxFramesQueued,
+                                mod_settings.inputJitterLow,
+                                mod_settings.inputJitterHigh);
                         inputReader = inputZeroMQReader;
                     }
 #endif
@@ -482,6 +778,11 @@ int launch_modulator(int argc, char* argv[])
             fprintf(stderr, "\n\n");
             etiLog.level(info) << m.framecount << " DAB frames encoded";
             etiLog.level(info) << ((float)m.framecount * 0.024f) << " seconds encoded";
+            if (mod_settings.encoderCacheSize > 0) {
+                auto cache = EncoderCache::shared(0);
+                etiLog.level(info) << "Encoder cache: " << cache->hits() <<
+                    " hits, " << cache->misses() << " misses";
+            }
 
             m.data.setLength(0);
         }
@@ -498,11 +799,13 @@ run_modulator_state_t run_modulator(modulator_data& m)
         while (running) {
 
             int framesize;
+            const uint8_t* frame = nullptr;
 
             PDEBUG("*****************************************\n");
             PDEBUG("* Starting main loop\n");
             PDEBUG("*****************************************\n");
-            while ((framesize = m.inputReader->GetNextFrame(m.data.getData())) > 0) {
+            while ((framesize = m.inputReader->GetNextFrameData(
+                            m.data.getData(), &frame)) > 0) {
                 if (!running) {
                     break;
                 }
@@ -513,8 +816,9 @@ run_modulator_state_t run_modulator(modulator_data& m)
                 PDEBUG("* Read frame %lu\n", m.framecount);
                 PDEBUG("*****************************************\n");
 
-                const int eti_bytes_read = m.etiReader->loadEtiData(m.data);
-                if ((size_t)eti_bytes_read != m.data.getLength()) {
+                const int eti_bytes_read =
+                    m.etiReader->loadEtiData(frame, framesize);
+                if (eti_bytes_read != framesize) {
                     etiLog.level(error) << "ETI frame incompletely read";
                     throw std::runtime_error("ETI read error");
                 }
@@ -533,11 +837,11 @@ run_modulator_state_t run_modulator(modulator_data& m)
             else {
                 etiLog.level(error) << "Input read error.";
             }
-            running = 0;
             ret = run_modulator_state_t::normal_end;
+            break;
         }
     } catch (zmq_input_overflow& e) {
-        // The ZeroMQ input has overflowed its buffer
+        // The ZeroMQ input worker stopped
         etiLog.level(warn) << e.what();
         ret = run_modulator_state_t::again;
     } catch (std::out_of_range& e) {
@@ -0,0 +1,76 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Compile-time geometry of the four DAB transmission modes.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+/* Geometry of a DAB transmission mode, EN 300 401 Clause 14. Blocks that
+ * instantiate their inner loops on these constants get fixed trip counts
+ * the compiler can unroll and vectorise. Mode 0 is not a valid mode here,
+ * it has to be mapped to mode 4 before.
+ */
+template<unsigned Mode>
+struct DabModeTraits;
+
+template<>
+struct DabModeTraits<1> {
+    static constexpr size_t nbSymbols = 76;
+    static constexpr size_t nbCarriers = 1536;
+    static constexpr size_t spacing = 2048;
+    static constexpr size_t nullSize = 2656;
+    static constexpr size_t symSize = 2552;
+    static constexpr size_t ficSizeOut = 288;
+};
+
+template<>
+struct DabModeTraits<2> {
+    static constexpr size_t nbSymbols = 76;
+    static constexpr size_t nbCarriers = 384;
+    static constexpr size_t spacing = 512;
+    static constexpr size_t nullSize = 664;
+    static constexpr size_t symSize = 638;
+    static constexpr size_t ficSizeOut = 288;
+};
+
+template<>
+struct DabModeTraits<3> {
+    static constexpr size_t nbSymbols = 153;
+    static constexpr size_t nbCarriers = 192;
+    static constexpr size_t spacing = 256;
+    static constexpr size_t nullSize = 345;
+    static constexpr size_t symSize = 319;
+    static constexpr size_t ficSizeOut = 384;
+};
+
+template<>
+struct DabModeTraits<4> {
+    static constexpr size_t nbSymbols = 76;
+    static constexpr size_t nbCarriers = 768;
+    static constexpr size_t spacing = 1024;
+    static constexpr size_t nullSize = 1328;
+    static constexpr size_t symSize = 1276;
+    static constexpr size_t ficSizeOut = 288;
+};
@@ -30,26 +30,27 @@
 
 #include "DabModulator.h"
 #include "PcDebug.h"
+#include "DabModeTraits.h"
 
 #include "FrameMultiplexer.h"
-#include "PrbsGenerator.h"
 #include "BlockPartitioner.h"
-#include "QpskSymbolMapper.h"
-#include "FrequencyInterleaver.h"
+#include "CarrierMapper.h"
 #include "PhaseReference.h"
-#include "DifferentialModulator.h"
 #include "NullSymbol.h"
 #include "SignalMultiplexer.h"
 #include "CicEqualizer.h"
 #include "OfdmGenerator.h"
 #include "GainControl.h"
 #include "GuardIntervalInserter.h"
+#include "SymbolStream.h"
+#include "FrameParallel.h"
 #include "Resampler.h"
-#include "ConvEncoder.h"
+#include "SubchannelEncoder.h"
 #include "FIRFilter.h"
 #include "MemlessPoly.h"
+#include "FrequencyShift.h"
 #include "TII.h"
-#include "PuncturingEncoder.h"
+#include "FftwWisdom.h"
 #include "TimeInterleaver.h"
 #include "TimestampDecoder.h"
 #include "RemoteControl.h"
@@ -65,6 +66,10 @@ DabModulator::DabModulator(EtiSource& etiSource,
     PDEBUG("DabModulator::DabModulator(%u, %u, %u, %zu) @ %p\n",
             outputRate, clockRate, dabMode, (size_t)gainMode, this);
 
+    if (m_settings.encoderCacheSize > 0) {
+        myEncoderCache = EncoderCache::shared(m_settings.encoderCacheSize);
+    }
+
     if (m_settings.dabMode == 0) {
         setMode(2);
     }
@@ -74,40 +79,32 @@ DabModulator::DabModulator(EtiSource& etiSource,
 }
 
 
+template<unsigned Mode>
+void DabModulator::setGeometry()
+{
+    myNbSymbols = DabModeTraits<Mode>::nbSymbols;
+    myNbCarriers = DabModeTraits<Mode>::nbCarriers;
+    mySpacing = DabModeTraits<Mode>::spacing;
+    myNullSize = DabModeTraits<Mode>::nullSize;
+    mySymSize = DabModeTraits<Mode>::symSize;
+    myFicSizeOut = DabModeTraits<Mode>::ficSizeOut;
+}
+
+
 void DabModulator::setMode(unsigned mode)
 {
     switch (mode) {
     case 1:
-        myNbSymbols = 76;
-        myNbCarriers = 1536;
-        mySpacing = 2048;
-        myNullSize = 2656;
-        mySymSize = 2552;
-        myFicSizeOut = 288;
+        setGeometry<1>();
         break;
     case 2:
-        myNbSymbols = 76;
-        myNbCarriers = 384;
-        mySpacing = 512;
-        myNullSize = 664;
-        mySymSize = 638;
-        myFicSizeOut = 288;
+        setGeometry<2>();
         break;
     case 3:
-        myNbSymbols = 153;
-        myNbCarriers = 192;
-        mySpacing = 256;
-        myNullSize = 345;
-        mySymSize = 319;
-        myFicSizeOut = 384;
+        setGeometry<3>();
         break;
     case 4:
-        myNbSymbols = 76;
-        myNbCarriers = 768;
-        mySpacing = 1024;
-        myNullSize = 1328;
-        mySymSize = 1276;
-        myFicSizeOut = 288;
+        setGeometry<4>();
         break;
     default:
         throw std::runtime_error("DabModulator::setMode invalid mode size");
@@ -134,14 +131,11 @@ int DabModulator::process(Buffer* dataOut)
         ////////////////////////////////////////////////////////////////
         // CIF data initialisation
         ////////////////////////////////////////////////////////////////
-        auto cifPrbs = make_shared<PrbsGenerator>(864 * 8, 0x110);
-        auto cifMux = make_shared<FrameMultiplexer>(myEtiSource);
+        myCifMux = make_shared<FrameMultiplexer>(myEtiSource);
         auto cifPart = make_shared<BlockPartitioner>(mode, myEtiSource.getFp());
 
-        auto cifMap = make_shared<QpskSymbolMapper>(myNbCarriers);
         auto cifRef = make_shared<PhaseReference>(mode);
-        auto cifFreq = make_shared<FrequencyInterleaver>(mode);
-        auto cifDiff = make_shared<DifferentialModulator>(myNbCarriers);
+        auto cifCarriers = make_shared<CarrierMapper>(mode, myNbCarriers);
 
         auto cifNull = make_shared<NullSymbol>(myNbCarriers);
         auto cifSig = make_shared<SignalMultiplexer>(
@@ -206,17 +200,26 @@ int DabModulator::process(Buffer* dataOut)
 
         shared_ptr<FIRFilter> cifFilter;
         if (not m_settings.filterTapsFilename.empty()) {
-            cifFilter = make_shared<FIRFilter>(m_settings.filterTapsFilename);
+            cifFilter = make_shared<FIRFilter>(m_settings.filterTapsFilename,
+                                               m_settings.sharedDspPool);
             rcs.enrol(cifFilter.get());
         }
 
         shared_ptr<MemlessPoly> cifPoly;
         if (not m_settings.polyCoefFilename.empty()) {
             cifPoly = make_shared<MemlessPoly>(m_settings.polyCoefFilename,
-                                               m_settings.polyNumThreads);
+                                               m_settings.polyNumThreads,
+                                               m_settings.sharedDspPool);
             rcs.enrol(cifPoly.get());
         }
 
+        shared_ptr<FrequencyShift> cifShift;
+        if (m_settings.enableFreqShift) {
+            cifShift = make_shared<FrequencyShift>(
+                    m_settings.freqShiftOffset, m_settings.outputRate);
+            rcs.enrol(cifShift.get());
+        }
+
         auto myOutput = make_shared<OutputMemory>(dataOut);
 
         shared_ptr<Resampler> cifRes;
@@ -230,8 +233,6 @@ int DabModulator::process(Buffer* dataOut)
             fprintf(stderr, "No resampler\n");
         }
 
-        myFlowgraph->connect(cifPrbs, cifMux);
-
         ////////////////////////////////////////////////////////////////
         // Processing FIC
         ////////////////////////////////////////////////////////////////
@@ -250,118 +251,77 @@ int DabModulator::process(Buffer* dataOut)
         PDEBUG("FIC:\n");
         PDEBUG(" Framesize: %zu\n", fic->getFramesize());
 
-        // Configuring prbs generator
-        auto ficPrbs = make_shared<PrbsGenerator>(myFicSizeIn, 0x110);
-
-        // Configuring convolutionnal encoder
-        auto ficConv = make_shared<ConvEncoder>(myFicSizeIn);
-
-        // Configuring puncturing encoder
-        auto ficPunc = make_shared<PuncturingEncoder>();
-        for (const auto &rule : fic->get_rules()) {
-            PDEBUG(" Adding rule:\n");
-            PDEBUG("  Length: %zu\n", rule.length());
-            PDEBUG("  Pattern: 0x%x\n", rule.pattern());
-            ficPunc->append_rule(rule);
-        }
-        PDEBUG(" Adding tail\n");
-        ficPunc->append_tail_rule(PuncturingRule(3, 0xcccccc));
-
-        myFlowgraph->connect(fic, ficPrbs);
-        myFlowgraph->connect(ficPrbs, ficConv);
-        myFlowgraph->connect(ficConv, ficPunc);
-        myFlowgraph->connect(ficPunc, cifPart);
-
-        ////////////////////////////////////////////////////////////////
-        // Configuring subchannels
-        ////////////////////////////////////////////////////////////////
-        for (const auto& subchannel : myEtiSource.getSubchannels()) {
-
-            ////////////////////////////////////////////////////////////
-            // Data initialisation
-            ////////////////////////////////////////////////////////////
-            size_t subchSizeIn = subchannel->framesize();
-            size_t subchSizeOut = subchannel->framesizeCu() * 8;
-
-            ////////////////////////////////////////////////////////////
-            // Modules configuration
-            ////////////////////////////////////////////////////////////
-
-            // Configuring subchannel
-            PDEBUG("Subchannel:\n");
-            PDEBUG(" Start address: %zu\n",
-                    subchannel->startAddress());
-            PDEBUG(" Framesize: %zu\n",
-                    subchannel->framesize());
-            PDEBUG(" Bitrate: %zu\n", subchannel->bitrate());
-            PDEBUG(" Framesize CU: %zu\n",
-                    subchannel->framesizeCu());
-            PDEBUG(" Protection: %zu\n",
-                    subchannel->protection());
-            PDEBUG("  Form: %zu\n",
-                    subchannel->protectionForm());
-            PDEBUG("  Level: %zu\n",
-                    subchannel->protectionLevel());
-            PDEBUG("  Option: %zu\n",
-                    subchannel->protectionOption());
-
-            // Configuring prbs genrerator
-            auto subchPrbs = make_shared<PrbsGenerator>(subchSizeIn, 0x110);
-
-            // Configuring convolutionnal encoder
-            auto subchConv = make_shared<ConvEncoder>(subchSizeIn);
-
-            // Configuring puncturing encoder
-            auto subchPunc =
-                make_shared<PuncturingEncoder>(subchannel->framesizeCu());
-
-            for (const auto& rule : subchannel->get_rules()) {
-                PDEBUG(" Adding rule:\n");
-                PDEBUG("  Length: %zu\n", rule.length());
-                PDEBUG("  Pattern: 0x%x\n", rule.pattern());
-                subchPunc->append_rule(rule);
-            }
-            PDEBUG(" Adding tail\n");
-            subchPunc->append_tail_rule(PuncturingRule(3, 0xcccccc));
-
-            // Configuring time interleaver
-            auto subchInterleaver = make_shared<TimeInterleaver>(subchSizeOut);
+        // Configuring energy dispersal, convolutional and puncturing encoder
+        auto ficEnc = make_shared<SubchannelEncoder>(
+                myFicSizeIn, fic->get_rules(), 0, myEncoderCache);
 
-            myFlowgraph->connect(subchannel, subchPrbs);
-            myFlowgraph->connect(subchPrbs, subchConv);
-            myFlowgraph->connect(subchConv, subchPunc);
-            myFlowgraph->connect(subchPunc, subchInterleaver);
-            myFlowgraph->connect(subchInterleaver, cifMux);
-        }
+        myFlowgraph->connect(fic, ficEnc);
+        myFlowgraph->connect(ficEnc, cifPart);
 
-        myFlowgraph->connect(cifMux, cifPart);
-        myFlowgraph->connect(cifPart, cifMap);
-        myFlowgraph->connect(cifMap, cifFreq);
-        myFlowgraph->connect(cifRef, cifDiff);
-        myFlowgraph->connect(cifFreq, cifDiff);
+        myFlowgraph->connect(myCifMux, cifPart);
+        myFlowgraph->connect(cifRef, cifCarriers);
+        myFlowgraph->connect(cifPart, cifCarriers);
         myFlowgraph->connect(cifNull, cifSig);
-        myFlowgraph->connect(cifDiff, cifSig);
+        myFlowgraph->connect(cifCarriers, cifSig);
         if (tii) {
             myFlowgraph->connect(tiiRef, tii);
             myFlowgraph->connect(tii, cifSig);
         }
 
-        if (useCicEq) {
-            myFlowgraph->connect(cifSig, cifCicEq);
-            myFlowgraph->connect(cifCicEq, cifOfdm);
+        // The back-end from the CIC equaliser to the guard interval
+        // inserter either works on whole frames, streams groups of symbols,
+        // or runs on several frames at the same time
+        shared_ptr<ModPlugin> cifBackEnd = cifGuard;
+        if (m_settings.parallelFrames > 1) {
+            const size_t groupSize = m_settings.streamSymbols > 0 ?
+                m_settings.streamSymbols : (1 + myNbSymbols);
+
+            vector<shared_ptr<ModCodec> > lanes;
+            for (size_t i = 0; i < m_settings.parallelFrames; i++) {
+                lanes.push_back(make_shared<SymbolStream>(
+                            (1 + myNbSymbols), myNbCarriers, mySpacing,
+                            myNullSize, mySymSize, groupSize,
+                            useCicEq ? cifCicEq : nullptr,
+                            cifOfdm, cifGain, cifGuard));
+            }
+
+            cifBackEnd = make_shared<FrameParallel>(lanes,
+                    (myNullSize + myNbSymbols * mySymSize) * sizeof(complexf),
+                    m_settings.sharedLanePool);
+            myFlowgraph->connect(cifSig, cifBackEnd);
+        }
+        else if (m_settings.streamSymbols > 0) {
+            cifBackEnd = make_shared<SymbolStream>(
+                    (1 + myNbSymbols), myNbCarriers, mySpacing,
+                    myNullSize, mySymSize, m_settings.streamSymbols,
+                    useCicEq ? cifCicEq : nullptr,
+                    cifOfdm, cifGain, cifGuard);
+            myFlowgraph->connect(cifSig, cifBackEnd);
         }
         else {
-            myFlowgraph->connect(cifSig, cifOfdm);
+            if (useCicEq) {
+                myFlowgraph->connect(cifSig, cifCicEq);
+                myFlowgraph->connect(cifCicEq, cifOfdm);
+            }
+            else {
+                myFlowgraph->connect(cifSig, cifOfdm);
+            }
+            myFlowgraph->connect(cifOfdm, cifGain);
+            myFlowgraph->connect(cifGain, cifGuard);
         }
-        myFlowgraph->connect(cifOfdm, cifGain);
-        myFlowgraph->connect(cifGain, cifGuard);
+
+        // The shift is the last stage. It commutes with the predistortion,
+        // which only depends on the amplitude of the samples.
+        auto cifLast = cifShift ?
+            static_pointer_cast<ModPlugin>(cifShift) :
+            static_pointer_cast<ModPlugin>(myOutput);
 
         auto cifOut = cifPoly ?
             static_pointer_cast<ModPlugin>(cifPoly) :
-            static_pointer_cast<ModPlugin>(myOutput);
+            cifLast;
 
         if (cifFilter) {
-            myFlowgraph->connect(cifGuard, cifFilter);
+            myFlowgraph->connect(cifBackEnd, cifFilter);
             if (cifRes) {
                 myFlowgraph->connect(cifFilter, cifRes);
                 myFlowgraph->connect(cifRes, cifOut);
@@ -372,22 +332,142 @@ int DabModulator::process(Buffer* dataOut)
         }
         else {
             if (cifRes) {
-                myFlowgraph->connect(cifGuard, cifRes);
+                myFlowgraph->connect(cifBackEnd, cifRes);
                 myFlowgraph->connect(cifRes, cifOut);
             }
             else {
-                myFlowgraph->connect(cifGuard, cifOut);
+                myFlowgraph->connect(cifBackEnd, cifOut);
             }
         }
 
         if (cifPoly) {
-            myFlowgraph->connect(cifPoly, myOutput);
+            myFlowgraph->connect(cifPoly, cifLast);
+        }
+
+        if (cifShift) {
+            myFlowgraph->connect(cifShift, myOutput);
+        }
+
+        // Keep the wisdom of the plans just created for the next start
+        if (not m_settings.fftwWisdomFilename.empty()) {
+            fftw_wisdom_save(m_settings.fftwWisdomFilename);
         }
     }
 
+    ////////////////////////////////////////////////////////////////////
+    // Configuring subchannels
+    ////////////////////////////////////////////////////////////////////
+    updateSubchannels();
+
     ////////////////////////////////////////////////////////////////////
     // Processing data
     ////////////////////////////////////////////////////////////////////
     return myFlowgraph->run();
 }
 
+
+void DabModulator::updateSubchannels()
+{
+    using namespace std;
+
+    const auto subchannels = myEtiSource.getSubchannels();
+
+    if (subchannels.size() == mySubchannels.size() and
+            equal(subchannels.begin(), subchannels.end(),
+                mySubchannels.begin(),
+                [](const shared_ptr<SubchannelSource>& s,
+                   const SubchannelBranch& b) { return s == b.source; })) {
+        return;
+    }
+
+    if (not mySubchannels.empty()) {
+        etiLog.level(info) << "Reconfiguring " << subchannels.size() <<
+            " subchannels";
+    }
+
+    // The multiplexer takes its inputs in the order of the subchannels,
+    // all branches get reconnected to it below
+    for (const auto& branch : mySubchannels) {
+        myFlowgraph->disconnect(branch.interleaver, myCifMux);
+    }
+
+    vector<SubchannelBranch> branches;
+    for (const auto& subchannel : subchannels) {
+        // Keep the branch of an unchanged subchannel, so that its time
+        // interleaver history is preserved
+        auto old = find_if(mySubchannels.begin(), mySubchannels.end(),
+                [&](const SubchannelBranch& b) {
+                    return b.source->startAddress() == subchannel->startAddress() and
+                           b.source->framesize() == subchannel->framesize() and
+                           b.source->protection() == subchannel->protection();
+                });
+
+        if (old != mySubchannels.end()) {
+            if (old->source != subchannel) {
+                myFlowgraph->disconnect(old->source, old->encoder);
+                myFlowgraph->connect(subchannel, old->encoder);
+                old->source = subchannel;
+            }
+            branches.push_back(*old);
+            mySubchannels.erase(old);
+            continue;
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Data initialisation
+        ////////////////////////////////////////////////////////////
+        size_t subchSizeIn = subchannel->framesize();
+        size_t subchSizeOut = subchannel->framesizeCu() * 8;
+
+        ////////////////////////////////////////////////////////////
+        // Modules configuration
+        ////////////////////////////////////////////////////////////
+
+        // Configuring subchannel
+        PDEBUG("Subchannel:\n");
+        PDEBUG(" Start address: %zu\n",
+                subchannel->startAddress());
+        PDEBUG(" Framesize: %zu\n",
+                subchannel->framesize());
+        PDEBUG(" Bitrate: %zu\n", subchannel->bitrate());
+        PDEBUG(" Framesize CU: %zu\n",
+                subchannel->framesizeCu());
+        PDEBUG(" Protection: %zu\n",
+                subchannel->protection());
+        PDEBUG("  Form: %zu\n",
+                subchannel->protectionForm());
+        PDEBUG("  Level: %zu\n",
+                subchannel->protectionLevel());
+        PDEBUG("  Option: %zu\n",
+                subchannel->protectionOption());
+
+        SubchannelBranch branch;
+        branch.source = subchannel;
+
+        // Configuring energy dispersal, convolutional and puncturing
+        // encoder
+        branch.encoder = make_shared<SubchannelEncoder>(
+                subchSizeIn, subchannel->get_rules(),
+                subchannel->framesizeCu(), myEncoderCache);
+
+        // Configuring time interleaver
+        branch.interleaver = make_shared<TimeInterleaver>(subchSizeOut);
+
+        myFlowgraph->connect(branch.source, branch.encoder);
+        myFlowgraph->connect(branch.encoder, branch.interleaver);
+        branches.push_back(branch);
+    }
+
+    // Branches of subchannels that disappeared or changed
+    for (const auto& branch : mySubchannels) {
+        myFlowgraph->disconnect(branch.source, branch.encoder);
+        myFlowgraph->disconnect(branch.encoder, branch.interleaver);
+    }
+
+    for (const auto& branch : branches) {
+        myFlowgraph->connect(branch.interleaver, myCifMux);
+    }
+
+    mySubchannels.swap(branches);
+}
+
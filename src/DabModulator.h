@@ -34,11 +34,14 @@
 #include <sys/types.h>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "ModPlugin.h"
 #include "ConfigParser.h"
+#include "EncoderCache.h"
 #include "EtiReader.h"
 #include "Flowgraph.h"
+#include "FrameMultiplexer.h"
 #include "GainControl.h"
 #include "OutputMemory.h"
 #include "RemoteControl.h"
@@ -60,12 +63,30 @@ public:
 
 protected:
     void setMode(unsigned mode);
+    template<unsigned Mode> void setGeometry();
+
+    /* Add, remove or replace the subchannel branches of the flowgraph
+     * according to the subchannels of the current frame. Branches of
+     * unchanged subchannels are kept as they are.
+     */
+    void updateSubchannels();
 
     const mod_settings_t& m_settings;
 
     EtiSource& myEtiSource;
     std::shared_ptr<Flowgraph> myFlowgraph;
 
+    struct SubchannelBranch {
+        std::shared_ptr<SubchannelSource> source;
+        std::shared_ptr<ModPlugin> encoder;
+        std::shared_ptr<ModPlugin> interleaver;
+    };
+    std::vector<SubchannelBranch> mySubchannels;
+    std::shared_ptr<FrameMultiplexer> myCifMux;
+
+    // Shared by the encoders of the FIC and the subchannels, if enabled
+    std::shared_ptr<EncoderCache> myEncoderCache;
+
     size_t myNbSymbols;
     size_t myNbCarriers;
     size_t mySpacing;
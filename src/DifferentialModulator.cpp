@@ -20,19 +20,36 @@
  */
 
 #include "DifferentialModulator.h"
+#include "DabModeTraits.h"
 #include "PcDebug.h"
 
 #include <stdio.h>
 #include <stdexcept>
-#include <complex>
 #include <string.h>
-
-typedef std::complex<float> complexf;
+#include <math.h>
+#ifdef __AVX2__
+#   include <immintrin.h>
+#endif // __AVX2__
+
+/* Real and imaginary part of exp(j * n * pi/4), indexed by n */
+static const float phase_re[8] = {
+    1.0f,  (float)M_SQRT1_2,  0.0f, -(float)M_SQRT1_2,
+   -1.0f, -(float)M_SQRT1_2,  0.0f,  (float)M_SQRT1_2 };
+static const float phase_im[8] = {
+    0.0f,  (float)M_SQRT1_2,  1.0f,  (float)M_SQRT1_2,
+    0.0f, -(float)M_SQRT1_2, -1.0f, -(float)M_SQRT1_2 };
+
+static uint8_t phase_index(const complexf& symbol)
+{
+    const long n = lroundf(std::arg(symbol) * 4.0f / (float)M_PI);
+    return n & 0x07;
+}
 
 
 DifferentialModulator::DifferentialModulator(size_t carriers) :
     ModMux(),
-    d_carriers(carriers)
+    d_carriers(carriers),
+    d_phase(carriers)
 {
     PDEBUG("DifferentialModulator::DifferentialModulator(%zu)\n", carriers);
 
@@ -68,11 +85,11 @@ int DifferentialModulator::process(std::vector<Buffer*> dataIn, Buffer* dataOut)
     }
 
     size_t phaseSize = dataIn[0]->getLength() / sizeof(complexf);
-    size_t dataSize = dataIn[1]->getLength() / sizeof(complexf);
+    size_t dataSize = dataIn[1]->getLength();
     dataOut->setLength((phaseSize + dataSize) * sizeof(complexf));
 
     const complexf* phase = reinterpret_cast<const complexf*>(dataIn[0]->getData());
-    const complexf* in = reinterpret_cast<const complexf*>(dataIn[1]->getData());
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn[1]->getData());
     complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
 
     if (phaseSize != d_carriers) {
@@ -85,16 +102,64 @@ int DifferentialModulator::process(std::vector<Buffer*> dataIn, Buffer* dataOut)
     }
 
     memcpy(dataOut->getData(), phase, phaseSize * sizeof(complexf));
+    set_reference(phase);
+    out += d_carriers;
+
     for (size_t i = 0; i < dataSize; i += d_carriers) {
-        for (size_t j = 0; j < d_carriers; j += 4) {
-            out[d_carriers + j] = out[j] * in[j];
-            out[d_carriers + j + 1] = out[j + 1] * in[j + 1];
-            out[d_carriers + j + 2] = out[j + 2] * in[j + 2];
-            out[d_carriers + j + 3] = out[j + 3] * in[j + 3];
-        }
+        modulate_symbol(in, out);
         in += d_carriers;
         out += d_carriers;
     }
 
     return dataOut->getLength();
 }
+
+
+void DifferentialModulator::set_reference(const complexf* phase)
+{
+    for (size_t j = 0; j < d_carriers; ++j) {
+        d_phase[j] = phase_index(phase[j]);
+    }
+}
+
+
+template<size_t Carriers>
+void DifferentialModulator::modulate_symbol(const uint8_t* in, complexf* out)
+{
+    const size_t carriers = Carriers ? Carriers : d_carriers;
+    uint8_t* acc = d_phase.data();
+    size_t j = 0;
+#ifdef __AVX2__
+    const __m256 lut_re = _mm256_loadu_ps(phase_re);
+    const __m256 lut_im = _mm256_loadu_ps(phase_im);
+    const __m128i mask = _mm_set1_epi8(0x07);
+
+    for (; j + 8 <= carriers; j += 8) {
+        __m128i p = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(acc + j));
+        const __m128i d = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + j));
+        p = _mm_and_si128(_mm_add_epi8(p, d), mask);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(acc + j), p);
+
+        const __m256i idx = _mm256_cvtepu8_epi32(p);
+        const __m256 re = _mm256_permutevar8x32_ps(lut_re, idx);
+        const __m256 im = _mm256_permutevar8x32_ps(lut_im, idx);
+        const __m256 lo = _mm256_unpacklo_ps(re, im);
+        const __m256 hi = _mm256_unpackhi_ps(re, im);
+        float* o = reinterpret_cast<float*>(out + j);
+        _mm256_storeu_ps(o, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(o + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+#endif // __AVX2__
+    for (; j < carriers; ++j) {
+        acc[j] = (acc[j] + in[j]) & 0x07;
+        out[j] = complexf(phase_re[acc[j]], phase_im[acc[j]]);
+    }
+}
+
+
+// Generic kernel, and one with a fixed trip count for each mode
+template void DifferentialModulator::modulate_symbol<0>(const uint8_t*, complexf*);
+template void DifferentialModulator::modulate_symbol<DabModeTraits<1>::nbCarriers>(const uint8_t*, complexf*);
+template void DifferentialModulator::modulate_symbol<DabModeTraits<2>::nbCarriers>(const uint8_t*, complexf*);
+template void DifferentialModulator::modulate_symbol<DabModeTraits<3>::nbCarriers>(const uint8_t*, complexf*);
+template void DifferentialModulator::modulate_symbol<DabModeTraits<4>::nbCarriers>(const uint8_t*, complexf*);
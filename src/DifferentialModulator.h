@@ -30,8 +30,17 @@
 #include <vector>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <complex>
 
+typedef std::complex<float> complexf;
 
+/* The DifferentialModulator takes the phase reference symbol as complex
+ * values, and the data symbols as 8-PSK phase indices (see
+ * QpskSymbolMapper). As all phases involved are multiples of pi/4, the
+ * differential modulation is an addition modulo 8 of the phase indices,
+ * and the output symbols are taken from a table.
+ */
 class DifferentialModulator : public ModMux
 {
 public:
@@ -44,7 +53,20 @@ public:
     int process(std::vector<Buffer*> dataIn, Buffer* dataOut);
     const char* name() { return "DifferentialModulator"; }
 
+    /* Restart the differential modulation from the given d_carriers
+     * phase reference symbols */
+    void set_reference(const complexf* phase);
+
+    /* Modulate the d_carriers phase indices of the next OFDM symbol
+     * onto out. See QpskSymbolMapper::map_symbol() for Carriers.
+     */
+    template<size_t Carriers = 0>
+    void modulate_symbol(const uint8_t* in, complexf* out);
+
 protected:
     size_t d_carriers;
+
+    // Accumulated phase index for every carrier
+    std::vector<uint8_t> d_phase;
 };
 
@@ -0,0 +1,172 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Cache of the channel coding output of identical subchannel frames
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EncoderCache.h"
+#include "PcDebug.h"
+
+#include <cstring>
+#include <iterator>
+
+std::shared_ptr<EncoderCache> EncoderCache::shared(size_t capacity)
+{
+    static std::mutex instance_mutex;
+    static std::shared_ptr<EncoderCache> instance;
+
+    std::lock_guard<std::mutex> lock(instance_mutex);
+    if (not instance) {
+        instance = std::make_shared<EncoderCache>(capacity);
+    }
+    else {
+        instance->grow(capacity);
+    }
+    return instance;
+}
+
+EncoderCache::EncoderCache(size_t capacity) :
+    m_mutex(),
+    m_capacity(capacity),
+    m_entries(),
+    m_index()
+{
+    PDEBUG("EncoderCache::EncoderCache(%zu) @ %p\n", capacity, this);
+}
+
+void EncoderCache::grow(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (capacity > m_capacity) {
+        m_capacity = capacity;
+    }
+}
+
+uint64_t EncoderCache::hash(const void* data, size_t len, uint64_t seed)
+{
+    /* Hashing eight bytes at a time keeps the cost well below the one
+     * of the encoding it saves.
+     */
+    const uint64_t mult = 0x9e3779b97f4a7c15ULL;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (len * mult);
+
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        h = (h ^ word) * mult;
+        h ^= h >> 32;
+    }
+
+    uint64_t word = 0;
+    memcpy(&word, p, len);
+    h = (h ^ word) * mult;
+    h ^= h >> 29;
+    return h;
+}
+
+EncoderCache::key_t EncoderCache::make_key(
+        uint64_t config, const uint8_t* in, size_t len)
+{
+    key_t key;
+    key.config = config;
+    key.hash = hash(in, len, config);
+    return key;
+}
+
+uint64_t EncoderCache::combine(const key_t& key)
+{
+    return key.hash ^ (key.config * 0xc2b2ae3d27d4eb4fULL);
+}
+
+bool EncoderCache::lookup(const key_t& key, const uint8_t* in, size_t len,
+        uint8_t* out, size_t out_len)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto it = m_index.find(combine(key));
+    if (it == m_index.end()) {
+        m_misses++;
+        return false;
+    }
+
+    const entry_t& entry = *it->second;
+    if (entry.key.config != key.config or
+            entry.input.size() != len or
+            entry.output.size() != out_len or
+            memcmp(entry.input.data(), in, len) != 0) {
+        m_misses++;
+        return false;
+    }
+
+    memcpy(out, entry.output.data(), out_len);
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    m_hits++;
+    return true;
+}
+
+void EncoderCache::store(const key_t& key, const uint8_t* in, size_t len,
+        const uint8_t* out, size_t out_len)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_capacity == 0) {
+        return;
+    }
+
+    const uint64_t index = combine(key);
+    const auto it = m_index.find(index);
+    if (it != m_index.end()) {
+        // Another frame with the same hash is replaced
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    // The least recently used entry makes room, and its buffers are reused
+    if (m_entries.size() >= m_capacity) {
+        m_index.erase(combine(m_entries.back().key));
+        m_entries.splice(m_entries.begin(), m_entries,
+                std::prev(m_entries.end()));
+    }
+    else {
+        m_entries.emplace_front();
+    }
+
+    entry_t& entry = m_entries.front();
+    entry.key = key;
+    entry.input.assign(in, in + len);
+    entry.output.assign(out, out + out_len);
+    m_index[index] = m_entries.begin();
+}
+
+size_t EncoderCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t EncoderCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
@@ -0,0 +1,106 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Cache of the channel coding output of identical subchannel frames
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/* Padding, silence, static data services and looped input files repeat
+ * identical frames. The channel coding of a frame only depends on the
+ * frame and on the configuration of the encoder, so that the output of
+ * an identical frame can be copied from this cache instead.
+ *
+ * The cache is shared by all modulators of the process, and keeps the
+ * most recently used frames. Every entry also holds its input, that is
+ * compared on lookup, so that hash collisions cannot give wrong output.
+ */
+class EncoderCache
+{
+public:
+    /* The cache of the process, that keeps at least capacity frames */
+    static std::shared_ptr<EncoderCache> shared(size_t capacity);
+
+    explicit EncoderCache(size_t capacity);
+    EncoderCache(const EncoderCache&) = delete;
+    EncoderCache& operator=(const EncoderCache&) = delete;
+
+    struct key_t {
+        uint64_t config;
+        uint64_t hash;
+    };
+
+    /* 64-bit hash of the data, continuing from seed */
+    static uint64_t hash(const void* data, size_t len, uint64_t seed = 0);
+
+    /* The key of the input for an encoder with the given configuration,
+     * a hash of its parameters.
+     */
+    static key_t make_key(uint64_t config, const uint8_t* in, size_t len);
+
+    /* If the cache contains the output for this input, copy it to out
+     * and return true.
+     */
+    bool lookup(const key_t& key, const uint8_t* in, size_t len,
+            uint8_t* out, size_t out_len);
+
+    void store(const key_t& key, const uint8_t* in, size_t len,
+            const uint8_t* out, size_t out_len);
+
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct entry_t {
+        key_t key;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+    };
+
+    using lru_t = std::list<entry_t>;
+
+    static uint64_t combine(const key_t& key);
+    void grow(size_t capacity);
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+
+    // Most recently used first
+    lru_t m_entries;
+    std::unordered_map<uint64_t, lru_t::iterator> m_index;
+
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
+
@@ -31,6 +31,7 @@
 
 #include <stdexcept>
 #include <memory>
+#include <cmath>
 #include <sys/types.h>
 #include <string.h>
 #include <arpa/inet.h>
@@ -96,16 +97,23 @@ const std::vector<std::shared_ptr<SubchannelSource> > EtiReader::getSubchannels(
 
 int EtiReader::loadEtiData(const Buffer& dataIn)
 {
-    PDEBUG("EtiReader::loadEtiData(dataIn: %p)\n", &dataIn);
+    return loadEtiData(
+            reinterpret_cast<const uint8_t*>(dataIn.getData()),
+            dataIn.getLength());
+}
+
+int EtiReader::loadEtiData(const uint8_t* data, size_t size)
+{
+    PDEBUG("EtiReader::loadEtiData(data: %p, size: %zu)\n", data, size);
     PDEBUG(" state: %u\n", state);
-    const unsigned char* in = reinterpret_cast<const unsigned char*>(dataIn.getData());
-    size_t input_size = dataIn.getLength();
+    const unsigned char* in = data;
+    size_t input_size = size;
 
     while (input_size > 0) {
         switch (state) {
         case EtiReaderStateNbFrame:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             nb_frames = *(uint32_t*)in;
             input_size -= 4;
@@ -115,7 +123,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateFrameSize:
             if (input_size < 2) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             framesize = *(uint16_t*)in;
             input_size -= 2;
@@ -125,7 +133,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateSync:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             framesize = 6144;
             memcpy(&eti_sync, in, 4);
@@ -138,7 +146,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateFc:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             memcpy(&eti_fc, in, 4);
             eti_fc_valid = true;
@@ -163,7 +171,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateNst:
             if (input_size < 4 * (size_t)eti_fc.NST) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             if ((eti_stc.size() != eti_fc.NST) ||
                     (memcmp(&eti_stc[0], in, 4 * eti_fc.NST))) {
@@ -193,7 +201,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateEoh:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             memcpy(&eti_eoh, in, 4);
             input_size -= 4;
@@ -206,21 +214,19 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
         case EtiReaderStateFic:
             if (eti_fc.MID == 3) {
                 if (input_size < 128) {
-                    return dataIn.getLength() - input_size;
+                    return size - input_size;
                 }
                 PDEBUG("Writting 128 bytes of FIC channel data\n");
-                Buffer fic = Buffer(128, in);
-                myFicSource->loadFicData(fic);
+                myFicSource->loadFicData(in, 128);
                 input_size -= 128;
                 framesize -= 128;
                 in += 128;
             } else {
                 if (input_size < 96) {
-                    return dataIn.getLength() - input_size;
+                    return size - input_size;
                 }
                 PDEBUG("Writting 96 bytes of FIC channel data\n");
-                Buffer fic = Buffer(96, in);
-                myFicSource->loadFicData(fic);
+                myFicSource->loadFicData(in, 96);
                 input_size -= 96;
                 framesize -= 96;
                 in += 96;
@@ -229,19 +235,18 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateSubch:
             for (size_t i = 0; i < eti_stc.size(); ++i) {
-                unsigned size = mySources[i]->framesize();
-                PDEBUG("Writting %i bytes of subchannel data\n", size);
-                Buffer subch = Buffer(size, in);
-                mySources[i]->loadSubchannelData(subch);
-                input_size -= size;
-                framesize -= size;
-                in += size;
+                unsigned subch_size = mySources[i]->framesize();
+                PDEBUG("Writting %i bytes of subchannel data\n", subch_size);
+                mySources[i]->loadSubchannelData(in, subch_size);
+                input_size -= subch_size;
+                framesize -= subch_size;
+                in += subch_size;
             }
             state = EtiReaderStateEof;
             break;
         case EtiReaderStateEof:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             memcpy(&eti_eof, in, 4);
             input_size -= 4;
@@ -253,7 +258,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
             break;
         case EtiReaderStateTist:
             if (input_size < 4) {
-                return dataIn.getLength() - input_size;
+                return size - input_size;
             }
             memcpy(&eti_tist, in, 4);
             input_size -= 4;
@@ -282,7 +287,7 @@ int EtiReader::loadEtiData(const Buffer& dataIn)
     myTimestampDecoder.updateTimestampEti(eti_fc.FP & 0x3,
             eti_eoh.MNSC, getPPSOffset(), eti_fc.FCT);
 
-    return dataIn.getLength() - input_size;
+    return size - input_size;
 }
 
 bool EtiReader::sourceContainsTimestamp()
@@ -469,12 +474,18 @@ void EdiReader::add_subchannel(const EdiDecoder::eti_stc_data& stc)
         throw std::logic_error("Cannot add subchannel before protocol");
     }
 
-    if (m_sources.count(stc.stream_index) == 0) {
-        m_sources[stc.stream_index] = make_shared<SubchannelSource>(stc.sad, stc.stl(), stc.tpl);
-    }
-
     auto& source = m_sources[stc.stream_index];
 
+    // A new source is created when the subchannel changes, which tells
+    // the modulator to rebuild the corresponding branch
+    if (not source or
+            source->startAddress() != stc.sad or
+            source->framesize() != stc.mst.size() or
+            source->protection() != stc.tpl) {
+        source = make_shared<SubchannelSource>(stc.sad, stc.stl(), stc.tpl);
+    }
+    m_received_streams.insert(stc.stream_index);
+
     if (source->framesize() != stc.mst.size()) {
         throw std::invalid_argument(
                 "EDI: MST data length inconsistent with FIC");
@@ -519,6 +530,16 @@ void EdiReader::assemble()
     // Accept zero subchannels, because of an edge-case that can happen
     // during reconfiguration. See ETS 300 799 Clause 5.3.3
 
+    for (auto it = m_sources.begin(); it != m_sources.end();) {
+        if (m_received_streams.count(it->first) == 0) {
+            it = m_sources.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    m_received_streams.clear();
+
     if (m_utco == 0 and m_seconds == 0) {
         // We don't support relative-only timestamps
         m_fc.tsta = 0xFFFFFF; // disable TSTA
@@ -545,7 +566,8 @@ EdiUdpInput::EdiUdpInput(EdiDecoder::ETIDecoder& decoder) :
     m_port(0),
     m_decoder(decoder) { }
 
-void EdiUdpInput::Open(const std::string& uri)
+void EdiUdpInput::Open(const std::string& uri,
+        size_t jitter_low, size_t jitter_high)
 {
     etiLog.level(info) << "Opening EDI :" << uri;
 
@@ -556,13 +578,35 @@ void EdiUdpInput::Open(const std::string& uri)
 
         etiLog.level(info) << "EDI port :" << m_port;
 
-        // The max_fragments_queued is only a protection against a runaway
-        // memory usage.
-        // Rough calculation:
-        // 300 seconds, 24ms per frame, up to 20 fragments per frame
-        const size_t max_fragments_queued = 20 * 300 * 1000 / 24;
+        m_jitter.reset(new JitterBuffer(jitter_low, jitter_high));
+        rcs.enrol(m_jitter.get());
+
+        /* The jitter buffer keeps the backlog below its high watermark,
+         * or around the low one if it never drops. The packet buffers
+         * cover that many frames, plus one group of four, with up to
+         * eight PFT fragments per frame. Beyond that, the packets wait
+         * in the kernel receive buffer.
+         */
+        const size_t max_packets_per_frame = 8;
+        const size_t max_buffers = std::min<size_t>(
+                (std::max(jitter_high, 2 * jitter_low) + 4) *
+                max_packets_per_frame,
+                64 * 1024 * 1024 / UdpReceiver::max_packet_size);
+
+        // The kernel buffer absorbs the bursts while the modulator is busy
+        const size_t rcvbuf_size = 8 * 1024 * 1024;
+
+        m_udp_rx.start(m_port, max_buffers, rcvbuf_size);
+        etiLog.level(info) << "EDI input: " << max_buffers <<
+            " packet buffers of " << UdpReceiver::max_packet_size <<
+            " bytes";
+
+        if (m_udp_rx.receive_buffer_size() < rcvbuf_size) {
+            etiLog.level(warn) << "EDI input: the receive buffer is only " <<
+                m_udp_rx.receive_buffer_size() << " bytes, consider " <<
+                "increasing net.core.rmem_max to " << rcvbuf_size;
+        }
 
-        m_udp_rx.start(m_port, max_fragments_queued);
         m_enabled = true;
     }
 }
@@ -570,8 +614,17 @@ void EdiUdpInput::Open(const std::string& uri)
 bool EdiUdpInput::rxPacket()
 {
     try {
-        auto udp_data = m_udp_rx.get_packet_buffer();
-        m_decoder.push_packet(udp_data);
+        size_t prebuffering = 1;
+        if (m_frame_received and m_udp_rx.packets_queued() == 0) {
+            // Wait until the queue holds the low watermark again
+            m_jitter->underrun();
+            prebuffering = std::max<size_t>(1,
+                    lround(m_jitter->prebuffering() * m_packets_per_frame));
+        }
+
+        m_packet_time = m_udp_rx.get_packet(m_packet, prebuffering);
+        m_packets_since_frame++;
+        m_decoder.push_packet(m_packet);
         return true;
     }
     catch (std::runtime_error& e) {
@@ -580,3 +633,35 @@ bool EdiUdpInput::rxPacket()
     }
 }
 
+size_t EdiUdpInput::framesQueued() const
+{
+    return lround(m_udp_rx.packets_queued() / m_packets_per_frame);
+}
+
+bool EdiUdpInput::dropFrame(unsigned fp)
+{
+    /* The number of packets per frame depends on the PFT fragmentation
+     * and on the bitrate, follow it smoothly.
+     */
+    if (m_frame_received) {
+        m_packets_per_frame = 0.9 * m_packets_per_frame +
+            0.1 * m_packets_since_frame;
+    }
+    else if (m_packets_since_frame > 0) {
+        m_packets_per_frame = m_packets_since_frame;
+    }
+    m_packets_since_frame = 0;
+    m_frame_received = true;
+
+    const size_t kernel_drops = m_udp_rx.kernel_drops();
+    if (kernel_drops != m_kernel_drops) {
+        etiLog.level(warn) << "EDI input: " <<
+            kernel_drops - m_kernel_drops << " packets lost in the kernel";
+        m_kernel_drops = kernel_drops;
+    }
+
+    m_jitter->arrived(1, m_packet_time);
+
+    return m_jitter->drop(fp, framesQueued());
+}
+
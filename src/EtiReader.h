@@ -34,6 +34,7 @@
 #include "Eti.h"
 #include "Log.h"
 #include "FicSource.h"
+#include "JitterBuffer.h"
 #include "SubchannelSource.h"
 #include "TimestampDecoder.h"
 #include "lib/edi/ETIDecoder.hpp"
@@ -42,6 +43,7 @@
 
 #include <vector>
 #include <memory>
+#include <set>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -87,6 +89,10 @@ public:
      */
     int loadEtiData(const Buffer& dataIn);
 
+    /* Parse the frame in place, the FIC and subchannel data are not
+     * copied and must stay valid until the flowgraph has run. */
+    int loadEtiData(const uint8_t* data, size_t size);
+
     virtual bool sourceContainsTimestamp();
     virtual void calculateTimestamp(struct frame_timestamp& ts);
 
@@ -182,6 +188,9 @@ private:
 
     std::map<uint8_t, std::shared_ptr<SubchannelSource> > m_sources;
 
+    // Streams received since the last assemble(), others get removed
+    std::set<uint8_t> m_received_streams;
+
     TimestampDecoder m_timestamp_decoder;
 };
 
@@ -194,7 +203,9 @@ class EdiUdpInput {
     public:
         EdiUdpInput(EdiDecoder::ETIDecoder& decoder);
 
-        void Open(const std::string& uri);
+        /* The watermarks of the jitter buffer are in ETI frames */
+        void Open(const std::string& uri,
+                size_t jitter_low, size_t jitter_high);
 
         bool isEnabled(void) const { return m_enabled; }
 
@@ -204,11 +215,33 @@ class EdiUdpInput {
          */
         bool rxPacket(void);
 
+        /* Called for every frame the decoder assembled, with its frame
+         * phase. Returns true if the frame must be dropped because too
+         * many packets are waiting, see JitterBuffer.
+         */
+        bool dropFrame(unsigned fp);
+
     private:
+        /* Number of frames waiting in the queue of packets */
+        size_t framesQueued(void) const;
+
         bool m_enabled;
         int m_port;
 
         UdpReceiver m_udp_rx;
         EdiDecoder::ETIDecoder& m_decoder;
+
+        // Reused for every packet, to avoid allocations
+        std::vector<uint8_t> m_packet;
+        // Reception time of the last packet, that completed the frame
+        struct timespec m_packet_time = {0, 0};
+        size_t m_kernel_drops = 0;
+
+        std::unique_ptr<JitterBuffer> m_jitter;
+
+        // The queue holds packets, the jitter buffer counts frames
+        bool m_frame_received = false;
+        double m_packets_per_frame = 1.0;
+        size_t m_packets_since_frame = 0;
 };
 
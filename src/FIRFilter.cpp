@@ -71,9 +71,11 @@ static const std::array<float, 45> default_filter_taps({
         -0.00110450468492});
 
 
-FIRFilter::FIRFilter(const std::string& taps_file) :
+FIRFilter::FIRFilter(const std::string& taps_file,
+        std::shared_ptr<ParallelFor> pool) :
     PipelinedModCodec(),
     RemoteControllable("firfilter"),
+    m_pool(pool),
     m_taps_file(taps_file)
 {
     PDEBUG("FIRFilter::FIRFilter(%s) @ %p\n",
@@ -82,9 +84,13 @@ FIRFilter::FIRFilter(const std::string& taps_file) :
     RC_ADD_PARAMETER(ntaps, "(Read-only) number of filter taps.");
     RC_ADD_PARAMETER(tapsfile, "Filename containing filter taps. When written to, the new file gets automatically loaded.");
 
-    load_filter_taps(m_taps_file);
+    if (not m_pool) {
+        const unsigned int hw_concurrency = std::thread::hardware_concurrency();
+        m_pool = std::make_shared<ParallelFor>(
+                hw_concurrency > 1 ? hw_concurrency - 1 : 0, "firfilter");
+    }
 
-    start_pipeline_thread();
+    load_filter_taps(m_taps_file);
 }
 
 void FIRFilter::load_filter_taps(const std::string &tapsFile)
@@ -155,31 +161,36 @@ int FIRFilter::internal_process(Buffer* const dataIn, Buffer* dataOut)
             throw std::runtime_error("FIRFilterWorker: out not aligned");
         }
 
-        __m128 SSEout;
-        __m128 SSEtaps;
-        __m128 SSEin;
         {
             std::lock_guard<std::mutex> lock(m_taps_mutex);
 
-            for (i = 0; i < sizeIn - 2*m_taps.size(); i += 4) {
-                SSEout = _mm_setr_ps(0,0,0,0);
-
-                for (size_t j = 0; j < m_taps.size(); j++) {
-                    if ((uintptr_t)(&in[i+2*j]) % 16 == 0) {
-                        SSEin = _mm_load_ps(&in[i+2*j]); //faster when aligned
+            // The ranges given to the pool start at multiples of four
+            // floats, which keeps the stores aligned.
+            const size_t convEnd = sizeIn > 2*m_taps.size() ?
+                (sizeIn - 2*m_taps.size() + 3) / 4 * 4 : 0;
+
+            m_pool->run(convEnd, [&](size_t start, size_t stop) {
+                    for (size_t k = start; k < stop; k += 4) {
+                        __m128 SSEout = _mm_setr_ps(0,0,0,0);
+
+                        for (size_t j = 0; j < m_taps.size(); j++) {
+                            __m128 SSEin;
+                            if ((uintptr_t)(&in[k+2*j]) % 16 == 0) {
+                                SSEin = _mm_load_ps(&in[k+2*j]); //faster when aligned
+                            }
+                            else {
+                                SSEin = _mm_loadu_ps(&in[k+2*j]);
+                            }
+
+                            const __m128 SSEtaps = _mm_load1_ps(&m_taps[j]);
+
+                            SSEout = _mm_add_ps(SSEout, _mm_mul_ps(SSEin, SSEtaps));
+                        }
+                        _mm_store_ps(&out[k], SSEout);
                     }
-                    else {
-                        SSEin = _mm_loadu_ps(&in[i+2*j]);
-                    }
-
-                    SSEtaps = _mm_load1_ps(&m_taps[j]);
+                }, 4);
 
-                    SSEout = _mm_add_ps(SSEout, _mm_mul_ps(SSEin, SSEtaps));
-                }
-                _mm_store_ps(&out[i], SSEout);
-            }
-
-            for (; i < sizeIn; i++) {
+            for (i = convEnd; i < sizeIn; i++) {
                 out[i] = 0.0;
                 for (int j = 0; i+2*j < sizeIn; j++) {
                     out[i] += in[i+2*j] * m_taps[j];
@@ -196,25 +207,30 @@ int FIRFilter::internal_process(Buffer* const dataIn, Buffer* dataOut)
 
         {
             std::lock_guard<std::mutex> lock(m_taps_mutex);
+            const size_t convEnd = sizeIn > 2*m_taps.size() ?
+                (sizeIn - 2*m_taps.size() + 3) / 4 * 4 : 0;
+
             // Convolve by aligning both frame and taps at zero.
-            for (i = 0; i < sizeIn - 2*m_taps.size(); i += 4) {
-                out[i]    = 0.0;
-                out[i+1]  = 0.0;
-                out[i+2]  = 0.0;
-                out[i+3]  = 0.0;
-
-                for (size_t j = 0; j < m_taps.size(); j++) {
-                    out[i]   += in[i   + 2*j] * m_taps[j];
-                    out[i+1] += in[i+1 + 2*j] * m_taps[j];
-                    out[i+2] += in[i+2 + 2*j] * m_taps[j];
-                    out[i+3] += in[i+3 + 2*j] * m_taps[j];
-                }
-            }
+            m_pool->run(convEnd, [&](size_t start, size_t stop) {
+                    for (size_t k = start; k < stop; k += 4) {
+                        out[k]    = 0.0;
+                        out[k+1]  = 0.0;
+                        out[k+2]  = 0.0;
+                        out[k+3]  = 0.0;
+
+                        for (size_t j = 0; j < m_taps.size(); j++) {
+                            out[k]   += in[k   + 2*j] * m_taps[j];
+                            out[k+1] += in[k+1 + 2*j] * m_taps[j];
+                            out[k+2] += in[k+2 + 2*j] * m_taps[j];
+                            out[k+3] += in[k+3 + 2*j] * m_taps[j];
+                        }
+                    }
+                }, 4);
 
             // At the end of the frame, we cut the convolution off.
             // The beginning of the next frame starts with a NULL symbol
             // anyway.
-            for (; i < sizeIn; i++) {
+            for (i = convEnd; i < sizeIn; i++) {
                 out[i] = 0.0;
                 for (int j = 0; i+2*j < sizeIn; j++) {
                     out[i] += in[i+2*j] * m_taps[j];
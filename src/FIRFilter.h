@@ -35,6 +35,7 @@
 #include "ModPlugin.h"
 #include "PcDebug.h"
 #include "ThreadsafeQueue.h"
+#include "ParallelFor.h"
 
 #include <sys/types.h>
 #include <complex>
@@ -52,7 +53,11 @@ typedef std::complex<float> complexf;
 class FIRFilter : public PipelinedModCodec, public RemoteControllable
 {
 public:
-    FIRFilter(const std::string& taps_file);
+    /* The convolution is split over the given pool, or over a pool with
+     * one thread per CPU owned by the block.
+     */
+    FIRFilter(const std::string& taps_file,
+            std::shared_ptr<ParallelFor> pool = nullptr);
     virtual ~FIRFilter() = default;
 
     const char* name() { return "FIRFilter"; }
@@ -69,6 +74,9 @@ protected:
     virtual int internal_process(Buffer* const dataIn, Buffer* dataOut);
     void load_filter_taps(const std::string &tapsFile);
 
+    // Splits the convolution over the worker threads and the pipeline thread
+    std::shared_ptr<ParallelFor> m_pool;
+
     std::string m_taps_file;
 
     mutable std::mutex m_taps_mutex;
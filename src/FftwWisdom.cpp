@@ -0,0 +1,138 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Import and export of FFTW wisdom, to avoid the FFTW_MEASURE planning
+    cost on every flowgraph creation.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FftwWisdom.h"
+#include "DabModeTraits.h"
+#include "OfdmGenerator.h"
+#include "Resampler.h"
+#include "PcDebug.h"
+#include "Log.h"
+
+#include <fftw3.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+
+std::mutex fftw_planner_mutex;
+
+bool fftw_wisdom_load(const std::string& filename)
+{
+    FILE* fd = fopen(filename.c_str(), "r");
+    if (fd == nullptr) {
+        if (errno != ENOENT) {
+            etiLog.level(warn) << "Cannot open FFTW wisdom file " <<
+                filename << ": " << strerror(errno);
+        }
+        return false;
+    }
+
+    int success = 0;
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex);
+        success = fftwf_import_wisdom_from_file(fd);
+    }
+    fclose(fd);
+
+    if (not success) {
+        etiLog.level(warn) << "Invalid FFTW wisdom in " << filename;
+        return false;
+    }
+
+    etiLog.level(debug) << "Loaded FFTW wisdom from " << filename;
+    return true;
+}
+
+void fftw_wisdom_save(const std::string& filename)
+{
+    /* Write to a temporary file first, so that a concurrent reader never
+     * sees an incomplete file. The modulators of one process save one
+     * after the other, and every process uses its own temporary file.
+     */
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
+
+    const std::string tmp_filename =
+        filename + "." + std::to_string(getpid()) + ".tmp";
+    FILE* fd = fopen(tmp_filename.c_str(), "w");
+    if (fd == nullptr) {
+        etiLog.level(warn) << "Cannot write FFTW wisdom file " <<
+            tmp_filename << ": " << strerror(errno);
+        return;
+    }
+
+    fftwf_export_wisdom_to_file(fd);
+
+    if (fclose(fd) != 0 or rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        etiLog.level(warn) << "Cannot write FFTW wisdom file " <<
+            filename << ": " << strerror(errno);
+        remove(tmp_filename.c_str());
+        return;
+    }
+
+    PDEBUG("Saved FFTW wisdom to %s\n", filename.c_str());
+}
+
+void fftw_plan_wisdom(const mod_settings_t& settings)
+{
+    if (settings.fftwWisdomFilename.empty()) {
+        throw std::invalid_argument(
+                "Planning FFTW wisdom requires a wisdom file");
+    }
+
+    struct mode_t {
+        size_t nbSymbols;
+        size_t nbCarriers;
+        size_t spacing;
+    };
+    const mode_t modes[] = {
+        {DabModeTraits<1>::nbSymbols, DabModeTraits<1>::nbCarriers,
+            DabModeTraits<1>::spacing},
+        {DabModeTraits<2>::nbSymbols, DabModeTraits<2>::nbCarriers,
+            DabModeTraits<2>::spacing},
+        {DabModeTraits<3>::nbSymbols, DabModeTraits<3>::nbCarriers,
+            DabModeTraits<3>::spacing},
+        {DabModeTraits<4>::nbSymbols, DabModeTraits<4>::nbCarriers,
+            DabModeTraits<4>::spacing} };
+
+    for (const auto& mode : modes) {
+        etiLog.level(info) << "Planning FFTs for spacing " << mode.spacing;
+
+        // The constructors create the plans
+        OfdmGenerator ofdm(1 + mode.nbSymbols, mode.nbCarriers,
+                mode.spacing, settings.enableCfr, settings.cfrClip,
+                settings.cfrErrorClip);
+
+        if (settings.outputRate != 2048000) {
+            Resampler resampler(2048000, settings.outputRate, mode.spacing);
+        }
+    }
+
+    fftw_wisdom_save(settings.fftwWisdomFilename);
+    etiLog.level(info) << "FFTW wisdom saved to " <<
+        settings.fftwWisdomFilename;
+}
@@ -0,0 +1,55 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Import and export of FFTW wisdom, to avoid the FFTW_MEASURE planning
+    cost on every flowgraph creation.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include "ConfigParser.h"
+#include <mutex>
+#include <string>
+
+/* The FFTW planner is not thread-safe. The blocks hold this mutex while
+ * they create or destroy plans, because several modulators can build
+ * their flowgraphs at the same time.
+ */
+extern std::mutex fftw_planner_mutex;
+
+/* Import the wisdom stored in filename. A missing file is not an error,
+ * it gets created by the first save. Returns true if wisdom was loaded.
+ */
+bool fftw_wisdom_load(const std::string& filename);
+
+/* Export all wisdom accumulated so far to filename. */
+void fftw_wisdom_save(const std::string& filename);
+
+/* Create the plans of the OfdmGenerator and Resampler for all four DAB
+ * modes at the configured output rate, and save the resulting wisdom to
+ * the configured wisdom file.
+ */
+void fftw_plan_wisdom(const mod_settings_t& settings);
@@ -63,6 +63,7 @@ FicSource::FicSource(unsigned ficf, unsigned mid) :
         d_puncturing_rules.emplace_back(3 * 16, 0xeeeeeeec);
     }
     d_buffer.setLength(d_framesize);
+    loadFicData(d_buffer);
 }
 
 size_t FicSource::getFramesize()
@@ -73,6 +74,14 @@ size_t FicSource::getFramesize()
 void FicSource::loadFicData(const Buffer& fic)
 {
     d_buffer = fic;
+    d_data = reinterpret_cast<const uint8_t*>(d_buffer.getData());
+    d_data_size = d_buffer.getLength();
+}
+
+void FicSource::loadFicData(const uint8_t* fic, size_t size)
+{
+    d_data = fic;
+    d_data_size = size;
 }
 
 int FicSource::process(Buffer* outputData)
@@ -80,13 +89,13 @@ int FicSource::process(Buffer* outputData)
     PDEBUG("FicSource::process (outputData: %p, outputSize: %zu)\n",
             outputData, outputData->getLength());
 
-    if (d_buffer.getLength() != d_framesize) {
+    if (d_data_size != d_framesize) {
         throw std::runtime_error(
                 "ERROR: FicSource::process.outputSize != d_framesize: " +
-                std::to_string(d_buffer.getLength()) + " != " +
+                std::to_string(d_data_size) + " != " +
                 std::to_string(d_framesize));
     }
-    *outputData = d_buffer;
+    outputData->setData(d_data, d_data_size);
 
     return outputData->getLength();
 }
@@ -45,12 +45,18 @@ public:
     const std::vector<PuncturingRule>& get_rules();
 
     void loadFicData(const Buffer& fic);
+
+    /* Reference the FIC of the next frame without copying it. It must
+     * stay valid until process() has been called. */
+    void loadFicData(const uint8_t* fic, size_t size);
     int process(Buffer* outputData);
     const char* name() { return "FicSource"; }
 
 private:
     size_t d_framesize;
     Buffer d_buffer;
+    const uint8_t* d_data = nullptr;
+    size_t d_data_size = 0;
     std::vector<PuncturingRule> d_puncturing_rules;
 };
 
@@ -2,7 +2,7 @@
    Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
    the Queen in Right of Canada (Communications Research Center Canada)
 
-   Copyright (C) 2016
+   Copyright (C) 2017
    Matthias P. Braendli, matthias.braendli@mpb.li
 
     http://opendigitalradio.org
@@ -28,6 +28,7 @@
 #include "PcDebug.h"
 #include <memory>
 #include <algorithm>
+#include <map>
 #include <sstream>
 
 #if HAVE_DECL__MM_MALLOC
@@ -181,6 +182,7 @@ Edge::~Edge()
 
 
 Flowgraph::Flowgraph() :
+    mySorted(true),
     myProcessTime(0)
 {
     PDEBUG("Flowgraph::Flowgraph() @ %p\n", this);
@@ -244,14 +246,7 @@ void Flowgraph::connect(shared_ptr<ModPlugin> input, shared_ptr<ModPlugin> outpu
             }
         }
     } else if (inputNode > outputNode) {
-        shared_ptr<Node> node = *outputNode;
-        nodes.erase(outputNode);
-        outputNode = nodes.insert(nodes.end(), node);
-        for (inputNode = nodes.begin(); inputNode != nodes.end(); ++inputNode) {
-            if ((*inputNode)->plugin() == input) {
-                break;
-            }
-        }
+        mySorted = false;
     }
 
     assert((*inputNode)->plugin() == input);
@@ -260,11 +255,81 @@ void Flowgraph::connect(shared_ptr<ModPlugin> input, shared_ptr<ModPlugin> outpu
     edges.push_back(make_shared<Edge>(*inputNode, *outputNode));
 }
 
+void Flowgraph::disconnect(shared_ptr<ModPlugin> input, shared_ptr<ModPlugin> output)
+{
+    PDEBUG("Flowgraph::disconnect(input(%s): %p, output(%s): %p)\n",
+            input->name(), input.get(), output->name(), output.get());
+
+    auto edge = std::find_if(edges.begin(), edges.end(),
+            [&](const shared_ptr<Edge>& e) {
+                return e->srcNode()->plugin() == input and
+                       e->dstNode()->plugin() == output;
+            });
+    if (edge == edges.end()) {
+        throw std::invalid_argument(string("Flowgraph cannot disconnect ") +
+                input->name() + " from " + output->name());
+    }
+
+    auto srcNode = (*edge)->srcNode();
+    auto dstNode = (*edge)->dstNode();
+    edges.erase(edge);
+
+    for (const auto& node : {srcNode, dstNode}) {
+        const bool used = std::any_of(edges.begin(), edges.end(),
+                [&](const shared_ptr<Edge>& e) {
+                    return e->srcNode() == node or e->dstNode() == node;
+                });
+        if (not used) {
+            nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+        }
+    }
+}
+
+void Flowgraph::sort()
+{
+    PDEBUG("Flowgraph::sort()\n");
+
+    // Kahn's algorithm, keeping the insertion order of independent nodes
+    std::map<Node*, size_t> pending_inputs;
+    for (const auto& edge : edges) {
+        pending_inputs[edge->dstNode().get()]++;
+    }
+
+    std::vector<shared_ptr<Node> > sorted;
+    std::vector<bool> done(nodes.size(), false);
+    while (sorted.size() < nodes.size()) {
+        bool progress = false;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (done[i] or pending_inputs[nodes[i].get()] > 0) {
+                continue;
+            }
+            done[i] = true;
+            progress = true;
+            sorted.push_back(nodes[i]);
+            for (const auto& edge : edges) {
+                if (edge->srcNode() == nodes[i]) {
+                    pending_inputs[edge->dstNode().get()]--;
+                }
+            }
+        }
+        if (not progress) {
+            throw std::logic_error("Flowgraph contains a cycle");
+        }
+    }
+
+    nodes.swap(sorted);
+    mySorted = true;
+}
+
 
 bool Flowgraph::run()
 {
     PDEBUG("Flowgraph::run()\n");
 
+    if (not mySorted) {
+        sort();
+    }
+
     timeval start, stop;
     time_t diff;
 
@@ -2,7 +2,7 @@
    Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
    the Queen in Right of Canada (Communications Research Center Canada)
 
-   Copyright (C) 2016
+   Copyright (C) 2017
    Matthias P. Braendli, matthias.braendli@mpb.li
 
     http://opendigitalradio.org
@@ -81,6 +81,9 @@ public:
     Edge(const Edge&) = delete;
     Edge& operator=(const Edge&) = delete;
 
+    std::shared_ptr<Node> srcNode() { return mySrcNode; }
+    std::shared_ptr<Node> dstNode() { return myDstNode; }
+
 protected:
     std::shared_ptr<Node> mySrcNode;
     std::shared_ptr<Node> myDstNode;
@@ -98,11 +101,22 @@ public:
 
     void connect(std::shared_ptr<ModPlugin> input,
                  std::shared_ptr<ModPlugin> output);
+
+    /* Remove the edge between input and output. Nodes that are left
+     * without any edge are removed from the flowgraph. This can be called
+     * between two calls to run(), to modify a running flowgraph.
+     */
+    void disconnect(std::shared_ptr<ModPlugin> input,
+                    std::shared_ptr<ModPlugin> output);
     bool run();
 
 protected:
+    // Sort the nodes so that every node runs after all its inputs
+    void sort();
+
     std::vector<std::shared_ptr<Node> > nodes;
     std::vector<std::shared_ptr<Edge> > edges;
+    bool mySorted;
     time_t myProcessTime;
 };
 
@@ -25,6 +25,7 @@
  */
 
 #include "FrameMultiplexer.h"
+#include "PrbsGenerator.h"
 #include "PcDebug.h"
 
 #include <stdio.h>
@@ -39,17 +40,26 @@ typedef std::complex<float> complexf;
 FrameMultiplexer::FrameMultiplexer(
         const EtiSource& etiSource) :
     ModMux(),
-    m_etiSource(etiSource)
+    m_etiSource(etiSource),
+    m_prbs(PrbsGenerator::sequence(864 * 8, 0x110))
 {
 }
 
-// dataIn[0] -> PRBS
-// dataIn[1+] -> subchannels
+int FrameMultiplexer::process(
+        std::vector<Buffer*> dataIn,
+        std::vector<Buffer*> dataOut)
+{
+    if (dataOut.size() != 1) {
+        throw std::runtime_error("Invalid dataOut size for FrameMultiplexer " +
+                std::to_string(dataOut.size()));
+    }
+    return process(dataIn, dataOut[0]);
+}
+
+// dataIn[0+] -> subchannels
 int FrameMultiplexer::process(std::vector<Buffer*> dataIn, Buffer* dataOut)
 {
-    assert(dataIn.size() >= 1);
-    assert(dataIn[0]->getLength() == 864 * 8);
-    dataOut->setLength(dataIn[0]->getLength());
+    dataOut->setLength(m_prbs->size());
 
 #ifdef DEBUG
     fprintf(stderr, "FrameMultiplexer::process(dataIn:");
@@ -67,15 +77,14 @@ int FrameMultiplexer::process(std::vector<Buffer*> dataIn, Buffer* dataOut)
     std::vector<Buffer*>::const_iterator in = dataIn.begin();
 
     // Write PRBS
-    memcpy(out, (*in)->getData(), (*in)->getLength());
-    ++in;
+    memcpy(out, m_prbs->data(), m_prbs->size());
 
     // Write subchannel
     const auto subchannels = m_etiSource.getSubchannels();
-    if (subchannels.size() != dataIn.size() - 1) {
+    if (subchannels.size() != dataIn.size()) {
         throw std::out_of_range(
                 "FrameMultiplexer detected subchannel size change from " +
-                std::to_string(dataIn.size() - 1) + " to " +
+                std::to_string(dataIn.size()) + " to " +
                 std::to_string(subchannels.size()));
     }
     auto subchannel = subchannels.begin();
@@ -35,6 +35,7 @@
 #include "SubchannelSource.h"
 #include "EtiReader.h"
 #include <memory>
+#include <vector>
 
 #include <sys/types.h>
 
@@ -46,10 +47,16 @@ public:
             const EtiSource& etiSource);
 
     int process(std::vector<Buffer*> dataIn, Buffer* dataOut);
+
+    // Unlike other muxes, accepts zero inputs for ensembles without
+    // subchannels
+    int process(std::vector<Buffer*> dataIn, std::vector<Buffer*> dataOut);
     const char* name() { return "FrameMultiplexer"; }
 
 protected:
     const EtiSource& m_etiSource;
+    // Energy dispersal sequence filling the unused CUs, constant
+    std::shared_ptr<const std::vector<uint8_t> > m_prbs;
 };
 
 
@@ -0,0 +1,184 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Runs several instances of a block on consecutive frames concurrently
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameParallel.h"
+#include "PcDebug.h"
+#include "Utils.h"
+
+#include <cstring>
+#include <stdexcept>
+
+LanePool::LanePool(size_t num_threads)
+{
+    if (num_threads == 0) {
+        throw std::invalid_argument("LanePool: no thread");
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        m_threads.emplace_back(&LanePool::worker, this);
+    }
+}
+
+LanePool::~LanePool()
+{
+    // An empty job stops one thread
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        m_jobs.push({});
+    }
+
+    for (auto& t : m_threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+void LanePool::submit(const job_t& job)
+{
+    m_jobs.push(job);
+}
+
+void LanePool::worker()
+{
+    set_realtime_prio(1);
+    set_thread_name("frameparallel");
+
+    while (true) {
+        job_t job;
+        m_jobs.wait_and_pop(job);
+
+        if (not job) {
+            break;
+        }
+
+        job();
+    }
+}
+
+
+FrameParallel::lane_t::lane_t(std::shared_ptr<ModCodec> codec) :
+    codec(codec),
+    output(2) {}
+
+FrameParallel::FrameParallel(
+        const std::vector<std::shared_ptr<ModCodec> >& lanes,
+        size_t outputLength,
+        std::shared_ptr<LanePool> pool) :
+    ModCodec(),
+    m_outputLength(outputLength),
+    m_pool(pool),
+    m_running(true)
+{
+    PDEBUG("FrameParallel::FrameParallel(%zu, %zu) @ %p\n",
+            lanes.size(), outputLength, this);
+
+    if (lanes.empty()) {
+        throw std::invalid_argument("FrameParallel: no lane given");
+    }
+
+    for (const auto& codec : lanes) {
+        m_lanes.emplace_back(new lane_t(codec));
+    }
+
+    if (not m_pool) {
+        m_pool = std::make_shared<LanePool>(m_lanes.size());
+    }
+}
+
+FrameParallel::~FrameParallel()
+{
+    // The jobs still in the pool refer to the lanes
+    for (auto& lane : m_lanes) {
+        if (lane->busy) {
+            std::shared_ptr<Buffer> outbuffer;
+            lane->output.wait_and_pop(outbuffer);
+        }
+    }
+}
+
+int FrameParallel::process(Buffer* const dataIn, Buffer* dataOut)
+{
+    PDEBUG("FrameParallel::process(dataIn: %p, dataOut: %p)\n",
+            dataIn, dataOut);
+
+    if (not m_running) {
+        return 0;
+    }
+
+    auto inbuffer = std::make_shared<Buffer>(
+            dataIn->getLength(), dataIn->getData());
+
+    lane_t *next = m_lanes[m_next_lane].get();
+    next->busy = true;
+    m_pool->submit([this, next, inbuffer]() { run_lane(*next, inbuffer); });
+
+    m_next_lane = (m_next_lane + 1) % m_lanes.size();
+
+    if (m_number_of_runs < delay()) {
+        dataOut->setLength(m_outputLength);
+        memset(dataOut->getData(), 0, dataOut->getLength());
+        m_number_of_runs++;
+    }
+    else {
+        // The oldest frame in flight is in the lane after the one
+        // that just received a frame
+        auto& lane = *m_lanes[m_next_lane];
+
+        std::shared_ptr<Buffer> outbuffer;
+        lane.output.wait_and_pop(outbuffer);
+        lane.busy = false;
+
+        if (lane.exception) {
+            m_running = false;
+            std::rethrow_exception(lane.exception);
+        }
+
+        if (not outbuffer) {
+            m_running = false;
+            return 0;
+        }
+
+        dataOut->setData(outbuffer->getData(), outbuffer->getLength());
+    }
+
+    return dataOut->getLength();
+}
+
+void FrameParallel::run_lane(lane_t& lane, std::shared_ptr<Buffer> dataIn)
+{
+    auto dataOut = std::make_shared<Buffer>();
+
+    try {
+        if (lane.codec->process(dataIn.get(), dataOut.get()) == 0) {
+            dataOut.reset();
+        }
+    }
+    catch (...) {
+        lane.exception = std::current_exception();
+        dataOut.reset();
+    }
+
+    lane.output.push(dataOut);
+}
@@ -0,0 +1,122 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Runs several instances of a block on consecutive frames concurrently
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "SpscQueue.h"
+#include "ThreadsafeQueue.h"
+
+#include <sys/types.h>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* LanePool is the set of threads that run the frames handed over by
+ * FrameParallel blocks. Each job is one frame, jobs are run in the order
+ * they were submitted. Several FrameParallel blocks, e.g. those of the
+ * modulators of several ensembles, can share one pool.
+ */
+class LanePool
+{
+public:
+    using job_t = std::function<void()>;
+
+    LanePool(size_t num_threads);
+    LanePool(const LanePool&) = delete;
+    LanePool& operator=(const LanePool&) = delete;
+    ~LanePool();
+
+    size_t size() const { return m_threads.size(); }
+
+    void submit(const job_t& job);
+
+private:
+    void worker();
+
+    ThreadsafeQueue<job_t> m_jobs;
+    std::vector<std::thread> m_threads;
+};
+
+/* FrameParallel hands consecutive frames in turn to a set of lanes, each
+ * one a block without state across frames, and returns their outputs in
+ * the order of the input. With K lanes, K frames are processed at the
+ * same time on the threads of a LanePool, and the output is delayed by
+ * K-1 frames. The first K-1 outputs are zeros of outputLength bytes, like
+ * for a PipelinedModCodec.
+ *
+ * Without a pool given, FrameParallel creates one with a thread per lane.
+ *
+ * The lanes may share blocks, as long as these can process different
+ * frames concurrently (e.g. SymbolStream instances). A lane is given its
+ * next frame only once the previous one has been returned.
+ */
+class FrameParallel : public ModCodec
+{
+public:
+    FrameParallel(const std::vector<std::shared_ptr<ModCodec> >& lanes,
+            size_t outputLength,
+            std::shared_ptr<LanePool> pool = nullptr);
+    FrameParallel(const FrameParallel&) = delete;
+    FrameParallel& operator=(const FrameParallel&) = delete;
+    ~FrameParallel();
+
+    int process(Buffer* const dataIn, Buffer* dataOut) override;
+    const char* name() override { return "FrameParallel"; }
+
+    /* Number of frames the output is delayed by */
+    size_t delay() const { return m_lanes.size() - 1; }
+
+private:
+    struct lane_t {
+        lane_t(std::shared_ptr<ModCodec> codec);
+
+        std::shared_ptr<ModCodec> codec;
+        SpscQueue<std::shared_ptr<Buffer> > output;
+        std::exception_ptr exception;
+
+        // A frame was submitted and its output not yet taken
+        bool busy = false;
+    };
+
+    void run_lane(lane_t& lane, std::shared_ptr<Buffer> dataIn);
+
+    std::vector<std::unique_ptr<lane_t> > m_lanes;
+    size_t m_outputLength;
+    std::shared_ptr<LanePool> m_pool;
+
+    // The lane that receives the next frame
+    size_t m_next_lane = 0;
+    size_t m_number_of_runs = 0;
+    std::atomic<bool> m_running;
+};
+
@@ -20,14 +20,63 @@
  */
 
 #include "FrequencyInterleaver.h"
+#include "DabModeTraits.h"
 #include "PcDebug.h"
 
 #include <stdio.h>
 #include <stdexcept>
-#include <malloc.h>
-#include <complex>
+#include <stdint.h>
+#include <vector>
 
-typedef std::complex<float> complexf;
+/* Build the permutation of EN 300 401 Clause 14.6 for one transmission
+ * mode, stored as inverse indices: entry k is the index of the input
+ * carrier that ends up at output position k.
+ */
+static std::vector<uint16_t> build_inverse_table(
+        size_t carriers, size_t num, size_t beta)
+{
+    const size_t alpha = 13;
+    std::vector<uint16_t> table(carriers);
+
+    size_t index = 0;
+    size_t perm = 0;
+    PDEBUG("i: %4u, R: %4u\n", 0, 0);
+    for (size_t j = 1; j < num; ++j) {
+        perm = (alpha * perm + beta) & (num - 1);
+        if (perm >= ((num - carriers) / 2)
+                && perm <= (num - (num - carriers) / 2)
+                && perm != (num / 2)) {
+            const size_t dest = perm > num / 2 ?
+                perm - (1 + (num / 2)) : perm + (carriers - (num / 2));
+            PDEBUG("i: %4zu, R: %4zu, n: %4zu, k: %5zi, index: %zu\n",
+                    j, perm, index, perm - num / 2, dest);
+            table.at(dest) = index++;
+        } else {
+            PDEBUG("i: %4zu, R: %4zu\n", j, perm);
+        }
+    }
+
+    if (index != carriers) {
+        throw std::logic_error("FrequencyInterleaver: invalid permutation");
+    }
+
+    return table;
+}
+
+/* The permutation only depends on the transmission mode. The tables are
+ * built once, on first use, and shared by all instances.
+ */
+static const uint16_t* inverse_table(size_t mode)
+{
+    static const std::vector<uint16_t> tables[4] = {
+        build_inverse_table(768, 1024, 255),    // Mode 4
+        build_inverse_table(1536, 2048, 511),   // Mode 1
+        build_inverse_table(384, 512, 127),     // Mode 2
+        build_inverse_table(192, 256, 63),      // Mode 3
+    };
+
+    return tables[mode % 4].data();
+}
 
 
 FrequencyInterleaver::FrequencyInterleaver(size_t mode) :
@@ -36,66 +85,33 @@ FrequencyInterleaver::FrequencyInterleaver(size_t mode) :
     PDEBUG("FrequencyInterleaver::FrequencyInterleaver(%zu) @ %p\n",
             mode, this);
 
-    size_t num;
-    size_t alpha = 13;
-    size_t beta;
     switch (mode) {
     case 1:
         d_carriers = 1536;
-        num = 2048;
-        beta = 511;
         break;
     case 2:
         d_carriers = 384;
-        num = 512;
-        beta = 127;
         break;
     case 3:
         d_carriers = 192;
-        num = 256;
-        beta = 63;
         break;
     case 0:
     case 4:
         d_carriers = 768;
-        num = 1024;
-        beta = 255;
         break;
     default:
-        PDEBUG("Carriers: %zu\n", (d_carriers >> 1) << 1);
         throw std::runtime_error("FrequencyInterleaver::FrequencyInterleaver "
                 "nb of carriers invalid!");
         break;
     }
 
-    d_indexes = (size_t*)memalign(16, d_carriers * sizeof(size_t));
-    size_t* index = d_indexes;
-    size_t perm = 0;
-    PDEBUG("i: %4u, R: %4u\n", 0, 0);
-    for (size_t j = 1; j < num; ++j) {
-        perm = (alpha * perm + beta) & (num - 1);
-        if (perm >= ((num - d_carriers) / 2)
-                && perm <= (num - (num - d_carriers) / 2)
-                && perm != (num / 2)) {
-            PDEBUG("i: %4zu, R: %4zu, d: %4zu, n: %4zu, k: %5zi, index: %zu\n",
-                    j, perm, perm, index - d_indexes, perm - num / 2,
-                    perm > num / 2
-                    ?  perm - (1 + (num / 2))
-                    : perm + (d_carriers - (num / 2)));
-            *(index++) = perm > num / 2 ?
-                perm - (1 + (num / 2)) : perm + (d_carriers - (num / 2));
-        } else {
-            PDEBUG("i: %4zu, R: %4zu\n", j, perm);
-        }
-    }
+    d_indexes = inverse_table(mode);
 }
 
 
 FrequencyInterleaver::~FrequencyInterleaver()
 {
     PDEBUG("FrequencyInterleaver::~FrequencyInterleaver() @ %p\n", this);
-
-    free(d_indexes);
 }
 
 
@@ -107,25 +123,44 @@ int FrequencyInterleaver::process(Buffer* const dataIn, Buffer* dataOut)
 
     dataOut->setLength(dataIn->getLength());
 
-    const complexf* in = reinterpret_cast<const complexf*>(dataIn->getData());
-    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
-    size_t sizeIn = dataIn->getLength() / sizeof(complexf);
+    // The input carries one phase index per carrier, see QpskSymbolMapper
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
+    uint8_t* out = reinterpret_cast<uint8_t*>(dataOut->getData());
+    size_t sizeIn = dataIn->getLength();
 
     if (sizeIn % d_carriers != 0) {
         throw std::runtime_error(
                 "FrequencyInterleaver::process input size not valid!");
     }
 
-    for (size_t i = 0; i < sizeIn;) {
-//        memset(out, 0, d_carriers * sizeof(complexf));
-        for (size_t j = 0; j < d_carriers; i += 4, j += 4) {
-            out[d_indexes[j]] = in[i];
-            out[d_indexes[j + 1]] = in[i + 1];
-            out[d_indexes[j + 2]] = in[i + 2];
-            out[d_indexes[j + 3]] = in[i + 3];
-        }
-        out += d_carriers;
+    for (size_t i = 0; i < sizeIn; i += d_carriers) {
+        interleave_symbol(in + i, out + i);
     }
 
     return 1;
 }
+
+
+template<size_t Carriers>
+void FrequencyInterleaver::interleave_symbol(
+        const uint8_t* in, uint8_t* out) const
+{
+    /* Gather from the input, so that the output is written sequentially.
+     * Both the input symbol and the table fit comfortably in L1.
+     */
+    const size_t carriers = Carriers ? Carriers : d_carriers;
+    for (size_t k = 0; k < carriers; k += 4) {
+        out[k] = in[d_indexes[k]];
+        out[k + 1] = in[d_indexes[k + 1]];
+        out[k + 2] = in[d_indexes[k + 2]];
+        out[k + 3] = in[d_indexes[k + 3]];
+    }
+}
+
+
+// Generic kernel, and one with a fixed trip count for each mode
+template void FrequencyInterleaver::interleave_symbol<0>(const uint8_t*, uint8_t*) const;
+template void FrequencyInterleaver::interleave_symbol<DabModeTraits<1>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void FrequencyInterleaver::interleave_symbol<DabModeTraits<2>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void FrequencyInterleaver::interleave_symbol<DabModeTraits<3>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void FrequencyInterleaver::interleave_symbol<DabModeTraits<4>::nbCarriers>(const uint8_t*, uint8_t*) const;
@@ -29,6 +29,7 @@
 #include "ModPlugin.h"
 
 #include <sys/types.h>
+#include <stdint.h>
 
 
 class FrequencyInterleaver : public ModCodec
@@ -43,9 +44,16 @@ public:
     int process(Buffer* const dataIn, Buffer* dataOut);
     const char* name() { return "FrequencyInterleaver"; }
 
+    /* Interleave the d_carriers phase indices of one OFDM symbol. See
+     * QpskSymbolMapper::map_symbol() for Carriers.
+     */
+    template<size_t Carriers = 0>
+    void interleave_symbol(const uint8_t* in, uint8_t* out) const;
+
 protected:
     size_t d_carriers;
-    size_t d_num;
-    size_t* d_indexes;
+
+    // Inverse permutation, shared between all instances for a given mode
+    const uint16_t* d_indexes;
 };
 
@@ -0,0 +1,110 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Shifts the modulated signal in frequency
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrequencyShift.h"
+#include "PcDebug.h"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+FrequencyShift::FrequencyShift(double offset, size_t sampleRate,
+        size_t first_frame) :
+    ModCodec(),
+    RemoteControllable("freqshift"),
+    m_nco_mutex(),
+    m_nco(offset, sampleRate),
+    m_first_frame(first_frame)
+{
+    PDEBUG("FrequencyShift::FrequencyShift(%f, %zu, %zu) @ %p\n",
+            offset, sampleRate, first_frame, this);
+
+    RC_ADD_PARAMETER(offset, "Frequency shift in Hz");
+}
+
+int FrequencyShift::process(Buffer* const dataIn, Buffer* dataOut)
+{
+    PDEBUG("FrequencyShift::process(dataIn: %p, dataOut: %p)\n",
+            dataIn, dataOut);
+
+    dataOut->setLength(dataIn->getLength());
+
+    const complexf* in = reinterpret_cast<const complexf*>(dataIn->getData());
+    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
+    const size_t sizeOut = dataOut->getLength() / sizeof(complexf);
+
+    lock_guard<mutex> lock(m_nco_mutex);
+    if (m_first_frame > 0) {
+        m_nco.advance(m_first_frame * sizeOut);
+        m_first_frame = 0;
+    }
+    m_nco.mix(in, out, 0, sizeOut, false);
+    m_nco.advance(sizeOut);
+
+    return dataOut->getLength();
+}
+
+void FrequencyShift::set_parameter(const string& parameter,
+        const string& value)
+{
+    stringstream ss(value);
+    ss.exceptions ( stringstream::failbit | stringstream::badbit );
+
+    if (parameter == "offset") {
+        double offset;
+        ss >> offset;
+
+        lock_guard<mutex> lock(m_nco_mutex);
+        try {
+            m_nco.set_frequency(offset);
+        }
+        catch (const std::invalid_argument& e) {
+            throw ParameterError(e.what());
+        }
+    }
+    else {
+        stringstream ss;
+        ss << "Parameter '" << parameter
+            << "' is not exported by controllable " << get_rc_name();
+        throw ParameterError(ss.str());
+    }
+}
+
+const string FrequencyShift::get_parameter(const string& parameter) const
+{
+    stringstream ss;
+    if (parameter == "offset") {
+        lock_guard<mutex> lock(m_nco_mutex);
+        ss << std::fixed << m_nco.frequency();
+    }
+    else {
+        ss << "Parameter '" << parameter <<
+            "' is not exported by controllable " << get_rc_name();
+        throw ParameterError(ss.str());
+    }
+    return ss.str();
+}
+
@@ -0,0 +1,75 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Shifts the modulated signal in frequency
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "Nco.h"
+#include "RemoteControl.h"
+
+#include <sys/types.h>
+#include <mutex>
+#include <string>
+
+/* Moves the DAB block away from the centre frequency, e.g. to keep it
+ * away from the DC offset and the LO leakage of zero-IF devices. The
+ * shift is applied at the output rate, and can be changed through the
+ * remote control without a phase discontinuity.
+ */
+class FrequencyShift : public ModCodec, public RemoteControllable
+{
+    public:
+        /* The phase starts as if first_frame frames of the same size
+         * had been shifted before, for modulators that only produce a
+         * part of the output.
+         */
+        FrequencyShift(double offset, size_t sampleRate,
+                size_t first_frame = 0);
+        FrequencyShift(const FrequencyShift&) = delete;
+        FrequencyShift& operator=(const FrequencyShift&) = delete;
+
+        int process(Buffer* const dataIn, Buffer* dataOut) override;
+        const char* name() override { return "FrequencyShift"; }
+
+        /******* REMOTE CONTROL ********/
+        virtual void set_parameter(const std::string& parameter,
+                const std::string& value) override;
+
+        virtual const std::string get_parameter(
+                const std::string& parameter) const override;
+
+    private:
+        // The NCO is used by the modulator thread, and its frequency
+        // set by the RC thread
+        mutable std::mutex m_nco_mutex;
+        Nco m_nco;
+
+        size_t m_first_frame;
+};
+
@@ -0,0 +1,107 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Spin-then-sleep waiting for lock-free structures
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#if defined(__linux__)
+#   include <climits>
+#   include <linux/futex.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+/* An event is a counter that a thread increments with event_notify()
+ * after every change that another thread might wait for. A thread that
+ * waits with event_wait() first spins for a short while, because the
+ * other side usually makes progress within microseconds, and then sleeps
+ * on a futex as long as the counter has not changed. waiting counts the
+ * sleeping threads, so that notifying costs no system call when nobody
+ * sleeps.
+ */
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/* Spinning only helps if the other side runs on another core */
+inline int event_spin_iterations()
+{
+    static const int iterations =
+        std::thread::hardware_concurrency() > 1 ? 1000 : 0;
+    return iterations;
+}
+
+/* Block until ready() returns true */
+template<typename Predicate>
+void event_wait(std::atomic<uint32_t>& event,
+        std::atomic<uint32_t>& waiting, Predicate ready)
+{
+    for (int i = 0; i < event_spin_iterations(); i++) {
+        if (ready()) {
+            return;
+        }
+        cpu_relax();
+    }
+
+    while (true) {
+        const uint32_t ev = event.load(std::memory_order_acquire);
+        if (ready()) {
+            return;
+        }
+
+        waiting.fetch_add(1);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&event),
+                FUTEX_WAIT_PRIVATE, ev, nullptr, nullptr, 0);
+#else
+        if (event.load() == ev) {
+            std::this_thread::yield();
+        }
+#endif
+        waiting.fetch_sub(1);
+    }
+}
+
+/* Wake up all threads waiting on the event */
+inline void event_notify(std::atomic<uint32_t>& event,
+        std::atomic<uint32_t>& waiting)
+{
+    event.fetch_add(1);
+    if (waiting.load() > 0) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&event),
+                FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+}
+
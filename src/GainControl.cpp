@@ -43,7 +43,8 @@ union __u128 {
 
 using namespace std;
 
-static float var_variance;
+// Per thread, as several threads can compute gains at the same time
+static thread_local float var_variance;
 
 GainControl::GainControl(size_t framesize,
                          GainMode mode,
@@ -69,8 +70,6 @@ GainControl::GainControl(size_t framesize,
     RC_ADD_PARAMETER(digital, "Digital Gain");
     RC_ADD_PARAMETER(mode, "Gainmode (fix|max|var)");
     RC_ADD_PARAMETER(var, "Variance setting for gainmode var (default: 4)");
-
-    start_pipeline_thread();
 }
 
 GainControl::~GainControl()
@@ -86,6 +85,18 @@ int GainControl::internal_process(Buffer* const dataIn, Buffer* dataOut)
 
     dataOut->setLength(dataIn->getLength());
 
+    process_symbols(
+            reinterpret_cast<const complexf*>(dataIn->getData()),
+            reinterpret_cast<complexf*>(dataOut->getData()),
+            dataIn->getLength() / sizeof(complexf));
+
+    return dataOut->getLength() / sizeof(complexf);
+}
+
+
+void GainControl::process_symbols(
+        const complexf* dataIn, complexf* dataOut, size_t samples)
+{
 #ifdef __SSE__
     __m128 (*computeGain)(const __m128* in, size_t sizeIn);
 #else
@@ -115,10 +126,9 @@ int GainControl::internal_process(Buffer* const dataIn, Buffer* dataOut)
     }
 
 #ifdef __SSE__
-    const __m128* in  = reinterpret_cast<const __m128*>(dataIn->getData());
-    __m128* out       = reinterpret_cast<__m128*>(dataOut->getData());
-    size_t  sizeIn    = dataIn->getLength() / sizeof(__m128);
-    size_t  sizeOut   = dataOut->getLength() / sizeof(__m128);
+    const __m128* in  = reinterpret_cast<const __m128*>(dataIn);
+    __m128* out       = reinterpret_cast<__m128*>(dataOut);
+    size_t  sizeIn    = samples * sizeof(complexf) / sizeof(__m128);
     __u128  gain128;
 
 
@@ -145,10 +155,9 @@ int GainControl::internal_process(Buffer* const dataIn, Buffer* dataOut)
         out += m_frameSize;
     }
 #else // !__SSE__
-    const complexf* in = reinterpret_cast<const complexf*>(dataIn->getData());
-    complexf* out  = reinterpret_cast<complexf*>(dataOut->getData());
-    size_t sizeIn  = dataIn->getLength() / sizeof(complexf);
-    size_t sizeOut = dataOut->getLength() / sizeof(complexf);
+    const complexf* in = dataIn;
+    complexf* out  = dataOut;
+    size_t sizeIn  = samples;
     float  gain;
 
     if ((sizeIn % m_frameSize) != 0) {
@@ -173,8 +182,6 @@ int GainControl::internal_process(Buffer* const dataIn, Buffer* dataOut)
         out += m_frameSize;
     }
 #endif // __SSE__
-
-    return sizeOut;
 }
 
 
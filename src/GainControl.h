@@ -62,6 +62,12 @@ class GainControl : public PipelinedModCodec, public RemoteControllable
 
         const char* name() override { return "GainControl"; }
 
+        /* Apply the gain to samples samples, a multiple of the framesize
+         * given to the constructor, in the calling thread.
+         */
+        void process_symbols(
+                const complexf* dataIn, complexf* dataOut, size_t samples);
+
         /* Functions for the remote control */
         /* Base function to set parameters. */
         virtual void set_parameter(const std::string& parameter,
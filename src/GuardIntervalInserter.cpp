@@ -28,8 +28,6 @@
 #include <stdexcept>
 #include <complex>
 
-typedef std::complex<float> complexf;
-
 
 GuardIntervalInserter::GuardIntervalInserter(size_t nbSymbols,
         size_t spacing,
@@ -81,24 +79,27 @@ int GuardIntervalInserter::process(Buffer* const dataIn, Buffer* dataOut)
                 "GuardIntervalInserter::process input size not valid!");
     }
 
-    // Null symbol
-    if (myHasNull) {
-        // end - (nullSize - spacing) = 2 * spacing - nullSize
-        memcpy(out, &in[2 * d_spacing - d_nullSize],
-                (d_nullSize - d_spacing) * sizeof(complexf));
-        memcpy(&out[d_nullSize - d_spacing], in, d_spacing * sizeof(complexf));
-        in += d_spacing;
-        out += d_nullSize;
-    }
-    // Data symbols
-    for (size_t i = 0; i < d_nbSymbols; ++i) {
-        // end - (nullSize - spacing) = 2 * spacing - nullSize
-        memcpy(out, &in[2 * d_spacing - d_symSize],
-                (d_symSize - d_spacing) * sizeof(complexf));
-        memcpy(&out[d_symSize - d_spacing], in, d_spacing * sizeof(complexf));
-        in += d_spacing;
-        out += d_symSize;
-    }
+    process_symbols(in, out, 0, d_nbSymbols + (myHasNull ? 1 : 0));
 
     return sizeIn;
 }
+
+
+size_t GuardIntervalInserter::process_symbols(const complexf* in,
+        complexf* out, size_t first, size_t count) const
+{
+    size_t written = 0;
+    for (size_t i = first; i < first + count; ++i) {
+        // Null symbol
+        const size_t size = (myHasNull and i == 0) ? d_nullSize : d_symSize;
+
+        // end - (size - spacing) = 2 * spacing - size
+        memcpy(out, &in[2 * d_spacing - size],
+                (size - d_spacing) * sizeof(complexf));
+        memcpy(&out[size - d_spacing], in, d_spacing * sizeof(complexf));
+        in += d_spacing;
+        out += size;
+        written += size;
+    }
+    return written;
+}
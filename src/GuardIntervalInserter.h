@@ -29,6 +29,9 @@
 #include "ModPlugin.h"
 
 #include <sys/types.h>
+#include <complex>
+
+typedef std::complex<float> complexf;
 
 
 class GuardIntervalInserter : public ModCodec
@@ -43,6 +46,14 @@ public:
     int process(Buffer* const dataIn, Buffer* dataOut);
     const char* name() { return "GuardIntervalInserter"; }
 
+    /* Insert the guard intervals of count symbols of d_spacing samples,
+     * the first of which has the index first in the transmission frame.
+     * Index 0 is the null symbol if there is one. Returns the number of
+     * samples written to out.
+     */
+    size_t process_symbols(const complexf* in, complexf* out,
+            size_t first, size_t count) const;
+
 protected:
     size_t d_nbSymbols;
     size_t d_spacing;
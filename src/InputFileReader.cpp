@@ -39,12 +39,15 @@
 #include <errno.h>
 #include <stdint.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include "porting.h"
 #include "InputReader.h"
 #include "PcDebug.h"
 
 int InputFileReader::Open(std::string filename, bool loop)
 {
+    Close();
+
     filename_ = filename;
     loop_ = loop;
     inputfile_ = fopen(filename_.c_str(), "r");
@@ -54,7 +57,125 @@ int InputFileReader::Open(std::string filename, bool loop)
         return -1;
     }
 
-    return IdentifyType();
+    if (IdentifyType() != 0) {
+        return -1;
+    }
+
+    struct stat inputFileStat;
+    if (fstat(fileno(inputfile_), &inputFileStat) == 0 and
+            S_ISREG(inputFileStat.st_mode) and inputfilelength_ > 0) {
+        const long offset = ftell(inputfile_);
+        if (offset >= 0 and not MapFile(offset)) {
+            etiLog.level(warn) << "Unable to map input file, reading it instead";
+        }
+    }
+
+    return 0;
+}
+
+void InputFileReader::Close()
+{
+    if (map_ != NULL) {
+        munmap(const_cast<uint8_t*>(map_), inputfilelength_);
+        map_ = NULL;
+    }
+    if (old_map_ != NULL) {
+        munmap(const_cast<uint8_t*>(old_map_), old_map_length_);
+        old_map_ = NULL;
+    }
+    frames_.clear();
+    next_frame_ = 0;
+    index_end_ = 0;
+    index_truncated_ = false;
+
+    if (inputfile_ != NULL) {
+        fprintf(stderr, "\nClosing input file...\n");
+
+        fclose(inputfile_);
+        inputfile_ = NULL;
+    }
+}
+
+bool InputFileReader::MapFile(size_t offset)
+{
+    void* map = mmap(NULL, inputfilelength_, PROT_READ, MAP_PRIVATE,
+            fileno(inputfile_), 0);
+    if (map == MAP_FAILED) {
+        perror(filename_.c_str());
+        return false;
+    }
+    madvise(map, inputfilelength_, MADV_SEQUENTIAL);
+
+    map_ = reinterpret_cast<const uint8_t*>(map);
+
+    // Index the frames, so that reading and looping only ever look up
+    // the next entry
+    index_end_ = offset;
+    IndexFrames();
+    next_frame_ = 0;
+
+    return true;
+}
+
+void InputFileReader::IndexFrames()
+{
+    size_t pos = index_end_;
+    if (streamtype_ == ETI_STREAM_TYPE_RAW) {
+        for (; pos + 6144 <= inputfilelength_; pos += 6144) {
+            frames_.push_back({pos, 6144});
+        }
+    }
+    else {
+        while (pos + sizeof(uint16_t) <= inputfilelength_) {
+            uint16_t frameSize;
+            memcpy(&frameSize, map_ + pos, sizeof(frameSize));
+
+            if (frameSize > 6144 or
+                    pos + sizeof(frameSize) + frameSize > inputfilelength_) {
+                break;
+            }
+            frames_.push_back({pos + sizeof(frameSize), frameSize});
+            pos += sizeof(frameSize) + frameSize;
+        }
+    }
+    index_end_ = pos;
+
+    // Like with fread, the file must end exactly after the last frame
+    index_truncated_ = (pos != inputfilelength_);
+
+    nbframes_ = frames_.size();
+}
+
+bool InputFileReader::FollowFile()
+{
+    struct stat inputFileStat;
+    if (fstat(fileno(inputfile_), &inputFileStat) != 0 or
+            (size_t)inputFileStat.st_size <= inputfilelength_) {
+        return false;
+    }
+
+    const size_t length = inputFileStat.st_size;
+    void* map = mmap(NULL, length, PROT_READ, MAP_PRIVATE,
+            fileno(inputfile_), 0);
+    if (map == MAP_FAILED) {
+        perror(filename_.c_str());
+        return false;
+    }
+    madvise(map, length, MADV_SEQUENTIAL);
+
+    // The caller may still use the last frame of the current mapping
+    if (old_map_ != NULL) {
+        munmap(const_cast<uint8_t*>(old_map_), old_map_length_);
+    }
+    old_map_ = map_;
+    old_map_length_ = inputfilelength_;
+
+    map_ = reinterpret_cast<const uint8_t*>(map);
+    inputfilelength_ = length;
+
+    const size_t nb_indexed = frames_.size();
+    IndexFrames();
+    return frames_.size() > nb_indexed;
 }
 
 int InputFileReader::Rewind()
@@ -217,8 +338,71 @@ void InputFileReader::PrintInfo()
     }
 }
 
+int InputFileReader::GetNextFrameData(void* buffer, const uint8_t** frame)
+{
+    if (map_ == NULL) {
+        *frame = reinterpret_cast<const uint8_t*>(buffer);
+        return GetNextFrame(buffer);
+    }
+
+    if (next_frame_ == frames_.size() and FollowFile()) {
+        etiLog.level(debug) << "Input file grew to " << inputfilelength_ <<
+            " bytes";
+    }
+
+    if (next_frame_ == frames_.size()) {
+        if (index_truncated_) {
+            etiLog.level(error) <<
+                "Unable to read a complete frame from input file!";
+            return -1;
+        }
+        if (not loop_) {
+            return 0;
+        }
+        if (frames_.empty()) {
+            etiLog.level(error) << "No frame in input file!";
+            return -1;
+        }
+        next_frame_ = 0;
+    }
+
+    return GetFrameAt(next_frame_++, padded_frame_, frame);
+}
+
+int InputFileReader::GetFrameAt(size_t index, void* buffer,
+        const uint8_t** frame) const
+{
+    if (map_ == NULL or index >= frames_.size()) {
+        return -1;
+    }
+
+    const auto& entry = frames_[index];
+    PDEBUG("Frame size: %u\n", entry.size);
+
+    if (entry.size == 6144) {
+        *frame = map_ + entry.offset;
+    }
+    else {
+        uint8_t* padded = reinterpret_cast<uint8_t*>(buffer);
+        memcpy(padded, map_ + entry.offset, entry.size);
+        memset(padded + entry.size, 0x55, 6144 - entry.size);
+        *frame = padded;
+    }
+
+    return 6144;
+}
+
 int InputFileReader::GetNextFrame(void* buffer)
 {
+    if (map_ != NULL) {
+        const uint8_t* frame = NULL;
+        const int ret = GetNextFrameData(buffer, &frame);
+        if (ret > 0) {
+            memcpy(buffer, frame, ret);
+        }
+        return ret;
+    }
+
     uint16_t frameSize;
 
     if (streamtype_ == ETI_STREAM_TYPE_RAW) {
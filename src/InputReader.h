@@ -32,11 +32,14 @@
 #endif
 
 #include <cstdio>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
 #if defined(HAVE_ZEROMQ)
 #  include "zmq.hpp"
 #  include "ThreadsafeQueue.h"
+#  include "JitterBuffer.h"
 #endif
 #include "porting.h"
 #include "Log.h"
@@ -90,6 +93,16 @@ class InputReader
         // returns number of bytes written to buffer, 0 on eof, -1 on error
         virtual int GetNextFrame(void* buffer) = 0;
 
+        // Make frame point to the next frame, which stays valid until the
+        // next call. Readers that cannot give access to their data in place
+        // read it into buffer, which must hold 6144 bytes.
+        // returns the frame length, 0 on eof, -1 on error
+        virtual int GetNextFrameData(void* buffer, const uint8_t** frame)
+        {
+            *frame = reinterpret_cast<const uint8_t*>(buffer);
+            return GetNextFrame(buffer);
+        }
+
         // Print some information
         virtual void PrintInfo() = 0;
 };
@@ -103,11 +116,7 @@ class InputFileReader : public InputReader
 
         ~InputFileReader()
         {
-            if (inputfile_ != NULL) {
-                fprintf(stderr, "\nClosing input file...\n");
-
-                fclose(inputfile_);
-            }
+            Close();
         }
 
         // open file and determine stream type
@@ -119,11 +128,26 @@ class InputFileReader : public InputReader
 
         int GetNextFrame(void* buffer);
 
+        // Regular files are memory-mapped, and the frames are then
+        // accessed in place
+        int GetNextFrameData(void* buffer, const uint8_t** frame);
+
         EtiStreamType GetStreamType()
         {
             return streamtype_;
         }
 
+        // Random access to the frames of a memory-mapped file, used
+        // by the batch mode
+        bool IsMapped() const { return map_ != NULL; }
+        size_t GetNbFrames() const { return frames_.size(); }
+
+        // Make frame point to the frame at index, padding it into buffer
+        // (6144 bytes) if it is shorter. Does not move the read position.
+        // returns the frame length, -1 if the index is invalid
+        int GetFrameAt(size_t index, void* buffer,
+                const uint8_t** frame) const;
+
     private:
         InputFileReader(const InputFileReader& other) = delete;
         InputFileReader& operator=(const InputFileReader& other) = delete;
@@ -134,6 +158,20 @@ class InputFileReader : public InputReader
         // returns 0 on success, -1 on failure
         int Rewind();
 
+        // Map a regular file and index its frames, starting at offset.
+        // returns false if the file cannot be mapped.
+        bool MapFile(size_t offset);
+
+        // Add the frames after index_end_ to the index
+        void IndexFrames(void);
+
+        // A file that is still being written is followed: map it anew
+        // if it grew since it was mapped.
+        // returns true if frames were added to the index
+        bool FollowFile(void);
+
+        void Close();
+
         bool loop_; // if shall we loop the file over and over
         std::string filename_;
         EtiStreamType streamtype_;
@@ -142,6 +180,31 @@ class InputFileReader : public InputReader
         size_t inputfilelength_;
         uint64_t nbframes_; // 64-bit because 32-bit overflow is
                             // after 2**32 * 24ms ~= 3.3 years
+
+        // Mapping of the file, or NULL when reading it with fread
+        const uint8_t* map_ = NULL;
+
+        struct frame_index_t {
+            size_t offset; // of the frame data, without size prefix
+            uint16_t size;
+        };
+        std::vector<frame_index_t> frames_;
+        size_t next_frame_ = 0;
+
+        // File position after the last indexed frame
+        size_t index_end_ = 0;
+
+        // The previous mapping of a file that grew, released once the
+        // last frame given from it is not used any more
+        const uint8_t* old_map_ = NULL;
+        size_t old_map_length_ = 0;
+
+        // The file continues with an incomplete or invalid frame
+        // after the indexed frames
+        bool index_truncated_ = false;
+
+        // For frames shorter than 6144 bytes, that need padding
+        uint8_t padded_frame_[6144];
 };
 
 class InputTcpReader : public InputReader
@@ -172,16 +235,23 @@ struct zmq_input_overflow : public std::exception
 {
   const char* what () const throw ()
   {
-    return "InputZMQ buffer overflow";
+    return "InputZMQ worker stopped";
   }
 };
 
 #if defined(HAVE_ZEROMQ)
 /* A ZeroMQ input. See www.zeromq.org for more info */
 
+/* A 6144 byte ETI frame, that keeps the received ZeroMQ message alive. It
+ * points into the message if the frame is complete, or into a buffer
+ * holding the frame with its padding.
+ */
+using zmq_frame_t = std::shared_ptr<const uint8_t>;
+
 struct InputZeroMQThreadData
 {
-    ThreadsafeQueue<std::shared_ptr<std::vector<uint8_t> > > *in_messages;
+    ThreadsafeQueue<zmq_frame_t> *in_messages;
+    JitterBuffer *jitter;
     std::string uri;
     size_t max_queued_frames;
 };
@@ -191,8 +261,7 @@ class InputZeroMQWorker
     public:
         InputZeroMQWorker() :
             running(false),
-            zmqcontext(1),
-            m_to_drop(0) { }
+            zmqcontext(1) { }
 
         void Start(struct InputZeroMQThreadData* workerdata);
         void Stop();
@@ -205,14 +274,6 @@ class InputZeroMQWorker
 
         zmq::context_t zmqcontext; // is thread-safe
         boost::thread recv_thread;
-
-        /* We must be careful to keep frame phase consistent. If we
-         * drop a single ETI frame, we will break the transmission
-         * frame vs. ETI frame phase.
-         *
-         * Here we keep track of how many ETI frames we must drop
-         */
-        int m_to_drop;
 };
 
 class InputZeroMQReader : public InputReader
@@ -228,10 +289,16 @@ class InputZeroMQReader : public InputReader
             worker_.Stop();
         }
 
-        int Open(const std::string& uri, size_t max_queued_frames);
+        // The watermarks of the jitter buffer are in ETI frames, and
+        // must be below max_queued_frames
+        int Open(const std::string& uri, size_t max_queued_frames,
+                size_t jitter_low, size_t jitter_high);
 
         int GetNextFrame(void* buffer);
 
+        // The frames are given in place, without copy
+        int GetNextFrameData(void* buffer, const uint8_t** frame);
+
         void PrintInfo();
 
     private:
@@ -240,8 +307,12 @@ class InputZeroMQReader : public InputReader
         std::string uri_;
 
         InputZeroMQWorker worker_;
-        ThreadsafeQueue<std::shared_ptr<std::vector<uint8_t> > > in_messages_;
+        ThreadsafeQueue<zmq_frame_t> in_messages_;
+        std::unique_ptr<JitterBuffer> jitter_;
         struct InputZeroMQThreadData workerdata_;
+
+        // The frame last given by GetNextFrameData
+        zmq_frame_t current_frame_;
 };
 
 #endif
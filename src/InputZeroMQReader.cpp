@@ -35,9 +35,11 @@
 #include <cstring>
 #include <cstdio>
 #include <stdint.h>
+#include <time.h>
 #include "zmq.hpp"
 #include <boost/thread/thread.hpp>
 #include "porting.h"
+#include "Eti.h"
 #include "InputReader.h"
 #include "PcDebug.h"
 #include "Utils.h"
@@ -68,7 +70,8 @@ struct zmq_dab_message_t
 #define ZMQ_DAB_MESSAGE_T_HEADERSIZE \
     (sizeof(uint32_t) + NUM_FRAMES_PER_ZMQ_MESSAGE*sizeof(uint16_t))
 
-int InputZeroMQReader::Open(const string& uri, size_t max_queued_frames)
+int InputZeroMQReader::Open(const string& uri, size_t max_queued_frames,
+        size_t jitter_low, size_t jitter_high)
 {
     // The URL might start with zmq+tcp://
     if (uri.substr(0, 4) == "zmq+") {
@@ -78,7 +81,16 @@ int InputZeroMQReader::Open(const string& uri, size_t max_queued_frames)
         uri_ = uri;
     }
 
+    if (jitter_high != 0 and jitter_high >= max_queued_frames) {
+        throw invalid_argument("ZeroMQ input: the high watermark of the "
+                "jitter buffer must be below max_frames_queued");
+    }
+
+    jitter_.reset(new JitterBuffer(jitter_low, jitter_high));
+    rcs.enrol(jitter_.get());
+
     workerdata_.uri = uri_;
+    workerdata_.jitter = jitter_.get();
     workerdata_.max_queued_frames = max_queued_frames;
     // launch receiver thread
     worker_.Start(&workerdata_);
@@ -86,36 +98,71 @@ int InputZeroMQReader::Open(const string& uri, size_t max_queued_frames)
     return 0;
 }
 
+/* The received message, and the padded copies of its frames that are
+ * shorter than 6144 bytes. The frames in the queue share its ownership.
+ */
+struct zmq_message_block_t
+{
+    zmq::message_t message;
+    vector<uint8_t> padded;
+};
+
 int InputZeroMQReader::GetNextFrame(void* buffer)
+{
+    const uint8_t* frame = nullptr;
+    const int framesize = GetNextFrameData(buffer, &frame);
+    if (framesize > 0) {
+        memcpy(buffer, frame, framesize);
+    }
+    return framesize;
+}
+
+int InputZeroMQReader::GetNextFrameData(void* buffer, const uint8_t** frame)
 {
     const size_t framesize = 6144;
 
+    // The previous frame is not used any more
+    current_frame_.reset();
+
     if (not worker_.is_running()) {
         return 0;
     }
 
-    shared_ptr<vector<uint8_t> > incoming;
+    zmq_frame_t incoming;
+
+    while (true) {
+        /* Do some prebuffering because reads will happen in bursts
+         * (4 ETI frames in TM1) and we should make sure that
+         * we can serve the data required for a full transmission frame.
+         */
+        const size_t queue_size = in_messages_.size();
+        if (queue_size < 4) {
+            if (queue_size == 0) {
+                // Only an empty queue makes us wait for the sender
+                jitter_->underrun();
+            }
+            etiLog.log(trace, "ZMQ,wait1");
+            in_messages_.wait_and_pop(incoming, jitter_->prebuffering());
+        }
+        else {
+            etiLog.log(trace, "ZMQ,wait2");
+            in_messages_.wait_and_pop(incoming);
+        }
+        etiLog.log(trace, "ZMQ,pop");
 
-    /* Do some prebuffering because reads will happen in bursts
-     * (4 ETI frames in TM1) and we should make sure that
-     * we can serve the data required for a full transmission frame.
-     */
-    if (in_messages_.size() < 4) {
-        const size_t prebuffering = 10;
-        etiLog.log(trace, "ZMQ,wait1");
-        in_messages_.wait_and_pop(incoming, prebuffering);
-    }
-    else {
-        etiLog.log(trace, "ZMQ,wait2");
-        in_messages_.wait_and_pop(incoming);
-    }
-    etiLog.log(trace, "ZMQ,pop");
+        if (not worker_.is_running()) {
+            throw zmq_input_overflow();
+        }
 
-    if (not worker_.is_running()) {
-        throw zmq_input_overflow();
+        eti_FC fc;
+        memcpy(&fc, incoming.get() + sizeof(eti_SYNC), sizeof(fc));
+        if (not jitter_->drop(fc.FP, in_messages_.size())) {
+            break;
+        }
     }
 
-    memcpy(buffer, &incoming->front(), framesize);
+    current_frame_ = incoming;
+    *frame = current_frame_.get();
 
     return framesize;
 }
@@ -160,17 +207,33 @@ void InputZeroMQWorker::RecvProcess(struct InputZeroMQThreadData* workerdata)
     if (success) try {
         while (running)
         {
-            zmq::message_t incoming;
+            auto block = make_shared<zmq_message_block_t>();
+            zmq::message_t& incoming = block->message;
             subscriber.recv(&incoming);
 
-            if (m_to_drop) {
-                queue_size = workerdata->in_messages->size();
-                if (queue_size > 4) {
-                    workerdata->in_messages->notify();
+            struct timespec arrival;
+            clock_gettime(CLOCK_REALTIME, &arrival);
+            workerdata->jitter->arrived(NUM_FRAMES_PER_ZMQ_MESSAGE, arrival);
+
+            queue_size = workerdata->in_messages->size();
+
+            if (queue_size + NUM_FRAMES_PER_ZMQ_MESSAGE >
+                    workerdata->max_queued_frames) {
+                /* The jitter buffer drops frames when it gets above its
+                 * high watermark, this only happens when the modulator
+                 * does not take frames out any more. Whole messages are
+                 * dropped, to keep the transmission frame vs. ETI frame
+                 * phase.
+                 */
+                workerdata->in_messages->notify();
+                workerdata->jitter->overflow(NUM_FRAMES_PER_ZMQ_MESSAGE);
+
+                if (!buffer_full) {
+                    etiLog.level(warn) << "ZeroMQ buffer overfull !";
+                    buffer_full = true;
                 }
-                m_to_drop--;
             }
-            else if (queue_size < workerdata->max_queued_frames) {
+            else {
                 if (buffer_full) {
                     etiLog.level(info) << "ZeroMQ buffer recovered: " <<
                         queue_size << " elements";
@@ -192,6 +255,18 @@ void InputZeroMQWorker::RecvProcess(struct InputZeroMQThreadData* workerdata)
                     int offset = sizeof(dab_msg->version) +
                         NUM_FRAMES_PER_ZMQ_MESSAGE * sizeof(*dab_msg->buflen);
 
+                    /* Complete frames are used in place, the others are
+                     * copied once, into the padded buffer.
+                     */
+                    size_t num_padded = 0;
+                    for (int i = 0; i < NUM_FRAMES_PER_ZMQ_MESSAGE; i++) {
+                        if (dab_msg->buflen[i] < 6144) {
+                            num_padded++;
+                        }
+                    }
+                    block->padded.assign(num_padded * 6144, 0x55);
+                    uint8_t* padded = block->padded.data();
+
                     for (int i = 0; i < NUM_FRAMES_PER_ZMQ_MESSAGE; i++) {
                         if (dab_msg->buflen[i] > 6144) {
                             stringstream ss;
@@ -200,45 +275,31 @@ void InputZeroMQWorker::RecvProcess(struct InputZeroMQThreadData* workerdata)
                             throw runtime_error(ss.str());
                         }
                         else {
-                            auto buf = make_shared<vector<uint8_t> >(6144, 0x55);
-
                             const int framesize = dab_msg->buflen[i];
 
                             if ((ssize_t)incoming.size() < offset + framesize) {
                                 throw runtime_error("ZeroMQ packet too small");
                             }
 
-                            memcpy(&buf->front(),
-                                    ((uint8_t*)incoming.data()) + offset,
-                                    framesize);
+                            const uint8_t* data =
+                                ((const uint8_t*)incoming.data()) + offset;
+
+                            if (framesize < 6144) {
+                                memcpy(padded, data, framesize);
+                                data = padded;
+                                padded += 6144;
+                            }
 
                             offset += framesize;
 
-                            queue_size = workerdata->in_messages->push(buf);
+                            // Shares the ownership of the message block
+                            zmq_frame_t frame(block, data);
+                            queue_size = workerdata->in_messages->push(frame);
                             etiLog.log(trace, "ZMQ,push %zu", queue_size);
                         }
                     }
                 }
             }
-            else {
-                workerdata->in_messages->notify();
-
-                if (!buffer_full) {
-                    etiLog.level(warn) << "ZeroMQ buffer overfull !";
-
-                    buffer_full = true;
-                    throw runtime_error("ZMQ input full");
-                }
-
-                queue_size = workerdata->in_messages->size();
-
-                /* Drop three more incoming ETI frames before
-                 * we start accepting them again, to guarantee
-                 * that we keep transmission frame vs. ETI frame
-                 * phase.
-                 */
-                m_to_drop = 3;
-            }
 
             if (queue_size < 5) {
                 etiLog.level(warn) << "ZeroMQ buffer low: " << queue_size << " elements !";
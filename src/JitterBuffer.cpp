@@ -0,0 +1,229 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Watermark control of the queues of the network inputs
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JitterBuffer.h"
+#include "Log.h"
+#include "PcDebug.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+using namespace std::chrono;
+
+// Duration of one ETI frame, in seconds
+static const double frame_duration = 0.024;
+
+// Period over which the fill extremes are measured
+static const double window_duration = 10.0;
+
+JitterBuffer::JitterBuffer(size_t low, size_t high) :
+    RemoteControllable("jitterbuffer"),
+    m_mutex(),
+    m_low(low),
+    m_high(high)
+{
+    PDEBUG("JitterBuffer::JitterBuffer(%zu, %zu) @ %p\n", low, high, this);
+
+    if (low == 0 or (high != 0 and high <= low + 4)) {
+        throw invalid_argument("JitterBuffer: the high watermark must be "
+                "larger than the low watermark by more than four frames");
+    }
+
+    RC_ADD_PARAMETER(low, "Low watermark, in frames");
+    RC_ADD_PARAMETER(high, "High watermark, in frames, 0 to never drop");
+    RC_ADD_PARAMETER(fill, "(Read-only) frames in the queue");
+    RC_ADD_PARAMETER(fill_min, "(Read-only) minimum fill over the last 10s");
+    RC_ADD_PARAMETER(fill_max, "(Read-only) maximum fill over the last 10s");
+    RC_ADD_PARAMETER(dropped, "(Read-only) frames dropped above the high "
+            "watermark");
+    RC_ADD_PARAMETER(overflows, "(Read-only) frames dropped because the "
+            "queue was full");
+    RC_ADD_PARAMETER(underruns, "(Read-only) number of times the queue "
+            "ran dry");
+    RC_ADD_PARAMETER(drift, "(Read-only) arrival rate drift in ppm");
+}
+
+void JitterBuffer::arrived(size_t frames, const struct timespec& when)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    const double now = when.tv_sec + when.tv_nsec * 1e-9;
+
+    if (not m_drift_valid) {
+        // The frames that start the measurement are not counted
+        m_rate_start = now;
+        m_rate_arrived = m_arrived + frames;
+        m_drift_valid = true;
+    }
+    else {
+        /* The arrival rate is measured since the start or the last
+         * underrun, the jitter of the arrivals averages out over time.
+         */
+        const double elapsed = now - m_rate_start;
+        if (elapsed >= window_duration) {
+            const double rate = (m_arrived + frames - m_rate_arrived) / elapsed;
+            m_drift_ppm = (rate * frame_duration - 1.0) * 1e6;
+        }
+    }
+
+    m_arrived += frames;
+}
+
+void JitterBuffer::overflow(size_t frames)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_overflows += frames;
+}
+
+void JitterBuffer::underrun()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_underruns++;
+
+    // The pause of the sender would distort the arrival rate
+    m_drift_valid = false;
+}
+
+bool JitterBuffer::drop(unsigned fp, size_t fill)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    update_statistics(fill);
+
+    // Only decide at the start of a group of four frames
+    if (fp % 4 == 0) {
+        const size_t threshold = m_dropping ? (m_low + m_high) / 2 : m_high;
+        const bool was_dropping = m_dropping;
+        m_dropping = m_high != 0 and fill > threshold;
+
+        if (m_dropping and not was_dropping) {
+            etiLog.level(warn) << get_rc_name() << ": " << fill <<
+                " frames queued, dropping frames to catch up";
+        }
+    }
+
+    if (m_dropping) {
+        m_dropped++;
+    }
+    return m_dropping;
+}
+
+/* Called with m_mutex held */
+void JitterBuffer::update_statistics(size_t fill)
+{
+    const auto now = steady_clock::now();
+
+    m_fill = fill;
+
+    if (duration<double>(now - m_window_start).count() >= window_duration) {
+        m_fill_min = m_window_fill_min;
+        m_fill_max = m_window_fill_max;
+        m_window_start = now;
+        m_window_fill_min = fill;
+        m_window_fill_max = fill;
+    }
+    else {
+        m_window_fill_min = std::min(m_window_fill_min, fill);
+        m_window_fill_max = std::max(m_window_fill_max, fill);
+    }
+}
+
+void JitterBuffer::set_parameter(const string& parameter,
+        const string& value)
+{
+    stringstream ss(value);
+    ss.exceptions ( stringstream::failbit | stringstream::badbit );
+
+    lock_guard<mutex> lock(m_mutex);
+
+    if (parameter == "low" or parameter == "high") {
+        size_t watermark;
+        ss >> watermark;
+
+        const size_t low = (parameter == "low") ? watermark : m_low;
+        const size_t high = (parameter == "high") ? watermark : m_high;
+        if (low == 0 or (high != 0 and high <= low + 4)) {
+            throw ParameterError("The high watermark must be larger than "
+                    "the low watermark by more than four frames");
+        }
+        m_low = low;
+        m_high = high;
+    }
+    else if (parameter == "fill" or parameter == "fill_min" or
+            parameter == "fill_max" or parameter == "dropped" or
+            parameter == "overflows" or parameter == "underruns" or
+            parameter == "drift") {
+        throw ParameterError("Parameter '" + parameter + "' is read-only");
+    }
+    else {
+        stringstream ss;
+        ss << "Parameter '" << parameter
+            << "' is not exported by controllable " << get_rc_name();
+        throw ParameterError(ss.str());
+    }
+}
+
+const string JitterBuffer::get_parameter(const string& parameter) const
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    stringstream ss;
+    if (parameter == "low") {
+        ss << m_low;
+    }
+    else if (parameter == "high") {
+        ss << m_high;
+    }
+    else if (parameter == "fill") {
+        ss << m_fill;
+    }
+    else if (parameter == "fill_min") {
+        ss << m_fill_min;
+    }
+    else if (parameter == "fill_max") {
+        ss << m_fill_max;
+    }
+    else if (parameter == "dropped") {
+        ss << m_dropped;
+    }
+    else if (parameter == "overflows") {
+        ss << m_overflows;
+    }
+    else if (parameter == "underruns") {
+        ss << m_underruns;
+    }
+    else if (parameter == "drift") {
+        ss << std::fixed << m_drift_ppm;
+    }
+    else {
+        ss << "Parameter '" << parameter <<
+            "' is not exported by controllable " << get_rc_name();
+        throw ParameterError(ss.str());
+    }
+    return ss.str();
+}
+
@@ -0,0 +1,127 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Watermark control of the queues of the network inputs
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "RemoteControl.h"
+
+#include <sys/types.h>
+#include <time.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/* The JitterBuffer decides which frames leaving the queue of a network
+ * input get dropped, so that bursts and a sender running slightly fast do
+ * not let the queue grow until it overflows.
+ *
+ * When the queue holds more than the high watermark, the frames are
+ * dropped until it is back to the middle between the watermarks. Frames
+ * are only dropped in groups of four, starting at a frame phase FP
+ * multiple of four, so that the ETI frame vs. transmission frame phase is
+ * kept in all transmission modes. After the queue ran dry, the input waits
+ * until it holds the low watermark again.
+ *
+ * A high watermark of 0 disables the dropping, only the prebuffering
+ * after an underrun remains.
+ *
+ * The arrival rate is compared to the nominal rate of one frame every
+ * 24ms. It is measured on the arrival times given by the receiving side,
+ * e.g. the kernel reception timestamps of the packets, so that the time
+ * the frames spent in the queue does not enter it. This drift is only
+ * reported, together with the fill statistics,
+ * through the remote control. The buffer adapts to the drift through the
+ * drops alone, the watermarks are not changed.
+ */
+class JitterBuffer : public RemoteControllable
+{
+    public:
+        // Watermarks in ETI frames, see above for a high watermark of 0
+        JitterBuffer(size_t low, size_t high);
+        JitterBuffer(const JitterBuffer&) = delete;
+        JitterBuffer& operator=(const JitterBuffer&) = delete;
+
+        /* Number of frames the input waits for after an underrun */
+        size_t prebuffering() const { return m_low; }
+
+        /* Called by the receiving side for frames arriving, with their
+         * arrival time (CLOCK_REALTIME) */
+        void arrived(size_t frames, const struct timespec& when);
+
+        /* Called by the receiving side for frames it dropped because the
+         * queue was full */
+        void overflow(size_t frames);
+
+        /* Called when the queue ran dry */
+        void underrun();
+
+        /* Called for every frame taken out of the queue, with its frame
+         * phase and the number of frames still in the queue.
+         * returns true if the frame must be dropped
+         */
+        bool drop(unsigned fp, size_t fill);
+
+        /******* REMOTE CONTROL ********/
+        virtual void set_parameter(const std::string& parameter,
+                const std::string& value);
+
+        virtual const std::string get_parameter(
+                const std::string& parameter) const;
+
+    private:
+        void update_statistics(size_t fill);
+
+        mutable std::mutex m_mutex;
+
+        size_t m_low;
+        size_t m_high;
+        bool m_dropping = false;
+
+        size_t m_arrived = 0;
+
+        // Statistics
+        size_t m_fill = 0;
+        size_t m_fill_min = 0;
+        size_t m_fill_max = 0;
+        size_t m_dropped = 0;
+        size_t m_overflows = 0;
+        size_t m_underruns = 0;
+        double m_drift_ppm = 0.0;
+
+        // Start of the measurement of the arrival rate, in seconds
+        bool m_drift_valid = false;
+        double m_rate_start = 0.0;
+        size_t m_rate_arrived = 0;
+
+        // Window over which the fill extremes are measured
+        std::chrono::steady_clock::time_point m_window_start;
+        size_t m_window_fill_min = 0;
+        size_t m_window_fill_max = 0;
+};
+
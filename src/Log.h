@@ -176,6 +176,12 @@ class Logger {
          * so that you can write etiLog.level(info) << "stuff = " << 21 */
         LogLine level(log_level_t level);
 
+        /* The logger thread is started before the configuration is read,
+         * its placement has to be applied from outside. */
+        std::thread::native_handle_type io_thread_handle() {
+            return m_io_thread.native_handle();
+        }
+
     private:
         std::list<LogBackend*> backends;
 
@@ -51,9 +51,12 @@ using namespace std;
 // Number of AM/AM coefs, identical to number of AM/PM coefs
 #define NUM_COEFS 5
 
-MemlessPoly::MemlessPoly(const std::string& coefs_file, unsigned int num_threads) :
+MemlessPoly::MemlessPoly(const std::string& coefs_file,
+        unsigned int num_threads,
+        std::shared_ptr<ParallelFor> pool) :
     PipelinedModCodec(),
     RemoteControllable("memlesspoly"),
+    m_pool(pool),
     m_coefs_am(),
     m_coefs_pm(),
     m_coefs_file(coefs_file),
@@ -66,37 +69,26 @@ MemlessPoly::MemlessPoly(const std::string& coefs_file, unsigned int num_threads
     RC_ADD_PARAMETER(coeffile, "Filename containing coefficients. "
             "When set, the file gets loaded.");
 
-    if (num_threads == 0) {
+    if (m_pool) {
+        etiLog.level(info) << "Digital Predistorter will use the " <<
+            m_pool->concurrency() << " threads of the shared pool";
+    }
+    else if (num_threads == 0) {
         const unsigned int hw_concurrency = std::thread::hardware_concurrency();
         etiLog.level(info) << "Digital Predistorter will use " <<
             hw_concurrency << " threads (auto detected)";
-
-        for (size_t i = 0; i < hw_concurrency; i++) {
-            m_workers.emplace_back();
-        }
-
-        for (auto& worker : m_workers) {
-            worker.thread = std::thread(
-                    &MemlessPoly::worker_thread, &worker);
-        }
     }
     else {
         etiLog.level(info) << "Digital Predistorter will use " <<
             num_threads << " threads (set in config file)";
+    }
 
-        for (size_t i = 0; i < num_threads; i++) {
-            m_workers.emplace_back();
-        }
-
-        for (auto& worker : m_workers) {
-            worker.thread = std::thread(
-                    &MemlessPoly::worker_thread, &worker);
-        }
+    if (not m_pool) {
+        m_pool = std::make_shared<ParallelFor>(num_threads ? num_threads :
+                std::thread::hardware_concurrency(), "dpd");
     }
 
     load_coefficients(m_coefs_file);
-
-    start_pipeline_thread();
 }
 
 void MemlessPoly::load_coefficients(const std::string &coefFile)
@@ -268,33 +260,6 @@ static void apply_lut(
     }
 }
 
-void MemlessPoly::worker_thread(MemlessPoly::worker_t *workerdata)
-{
-    while (true) {
-        worker_t::input_data_t in_data;
-        workerdata->in_queue.wait_and_pop(in_data);
-
-        if (in_data.terminate) {
-            break;
-        }
-
-        switch (in_data.dpd_type) {
-            case dpd_type_t::odd_only_poly:
-                apply_coeff(in_data.coefs_am, in_data.coefs_pm,
-                        in_data.in, in_data.start, in_data.stop,
-                        in_data.out);
-                break;
-            case dpd_type_t::lookup_table:
-                apply_lut(in_data.lut, in_data.lut_scalefactor,
-                        in_data.in, in_data.start, in_data.stop,
-                        in_data.out);
-                break;
-        }
-
-        workerdata->out_queue.push(1);
-    }
-}
-
 int MemlessPoly::internal_process(Buffer* const dataIn, Buffer* dataOut)
 {
     dataOut->setLength(dataIn->getLength());
@@ -306,60 +271,19 @@ int MemlessPoly::internal_process(Buffer* const dataIn, Buffer* dataOut)
     if (m_dpd_settings_valid)
     {
         std::lock_guard<std::mutex> lock(m_coefs_mutex);
-        const size_t num_threads = m_workers.size();
-
-        if (num_threads > 0) {
-            const size_t step = sizeOut / num_threads;
-
-            size_t start = 0;
-            for (auto& worker : m_workers) {
-                worker_t::input_data_t dat;
-                dat.terminate = false;
-                dat.dpd_type = m_dpd_type;
-                dat.lut_scalefactor = m_lut_scalefactor;
-                dat.lut = m_lut.data();
-                dat.coefs_am = m_coefs_am.data();
-                dat.coefs_pm = m_coefs_pm.data();
-                dat.in = in;
-                dat.start = start;
-                dat.stop = start + step;
-                dat.out = out;
-
-                worker.in_queue.push(dat);
-
-                start += step;
-            }
 
-            // Do the last in this thread
-            switch (m_dpd_type) {
-                case dpd_type_t::odd_only_poly:
-                    apply_coeff(m_coefs_am.data(), m_coefs_pm.data(),
-                            in, start, sizeOut, out);
-                    break;
-                case dpd_type_t::lookup_table:
-                    apply_lut(m_lut.data(), m_lut_scalefactor,
-                            in, start, sizeOut, out);
-                    break;
-            }
-
-            // Wait for completion of the tasks
-            for (auto& worker : m_workers) {
-                int ret;
-                worker.out_queue.wait_and_pop(ret);
-            }
-        }
-        else {
-            switch (m_dpd_type) {
-                case dpd_type_t::odd_only_poly:
-                    apply_coeff(m_coefs_am.data(), m_coefs_pm.data(),
-                            in, 0, sizeOut, out);
-                    break;
-                case dpd_type_t::lookup_table:
-                    apply_lut(m_lut.data(), m_lut_scalefactor,
-                            in, 0, sizeOut, out);
-                    break;
-            }
-        }
+        m_pool->run(sizeOut, [&](size_t start, size_t stop) {
+                switch (m_dpd_type) {
+                    case dpd_type_t::odd_only_poly:
+                        apply_coeff(m_coefs_am.data(), m_coefs_pm.data(),
+                                in, start, stop, out);
+                        break;
+                    case dpd_type_t::lookup_table:
+                        apply_lut(m_lut.data(), m_lut_scalefactor,
+                                in, start, stop, out);
+                        break;
+                }
+            });
     }
     else {
         memcpy(dataOut->getData(), dataIn->getData(), sizeOut);
@@ -34,7 +34,7 @@
 #include "RemoteControl.h"
 #include "ModPlugin.h"
 #include "PcDebug.h"
-#include "ThreadsafeQueue.h"
+#include "ParallelFor.h"
 
 #include <sys/types.h>
 #include <complex>
@@ -58,7 +58,11 @@ enum class dpd_type_t {
 class MemlessPoly : public PipelinedModCodec, public RemoteControllable
 {
 public:
-    MemlessPoly(const std::string& coefs_file, unsigned int num_threads);
+    /* The frames are split over the given pool, or over a pool of
+     * num_threads workers (one per CPU if 0) owned by the block.
+     */
+    MemlessPoly(const std::string& coefs_file, unsigned int num_threads,
+            std::shared_ptr<ParallelFor> pool = nullptr);
 
     virtual const char* name() { return "MemlessPoly"; }
 
@@ -73,58 +77,8 @@ private:
     int internal_process(Buffer* const dataIn, Buffer* dataOut);
     void load_coefficients(const std::string &coefFile);
 
-    struct worker_t {
-        struct input_data_t {
-            bool terminate = false;
-
-            dpd_type_t dpd_type;
-
-            // Valid for polynomial types
-            const float *coefs_am = nullptr;
-            const float *coefs_pm = nullptr;
-
-            // Valid for LUT
-            float lut_scalefactor = 0.0f;
-            const complexf *lut = nullptr;
-
-            const complexf *in = nullptr;
-            size_t start = 0;
-            size_t stop = 0;
-            complexf *out = nullptr;
-        };
-
-        worker_t() {}
-        worker_t(const worker_t& other) = delete;
-        worker_t operator=(const worker_t& other) = delete;
-        worker_t operator=(worker_t&& other) = delete;
-
-        // The move constructor creates a new in_queue and out_queue,
-        // because ThreadsafeQueue is neither copy- nor move-constructible.
-        // Not an issue because creating the workers happens at startup, before
-        // the first work item.
-        worker_t(worker_t&& other) :
-            in_queue(),
-            out_queue(),
-            thread(std::move(other.thread)) {}
-
-        ~worker_t() {
-            if (thread.joinable()) {
-                input_data_t terminate_tag;
-                terminate_tag.terminate = true;
-                in_queue.push(terminate_tag);
-                thread.join();
-            }
-        }
-
-        ThreadsafeQueue<input_data_t> in_queue;
-        ThreadsafeQueue<int> out_queue;
-
-        std::thread thread;
-    };
-
-    std::vector<worker_t> m_workers;
-
-    static void worker_thread(worker_t *workerdata);
+    // Splits the frame over the worker threads and the pipeline thread
+    std::shared_ptr<ParallelFor> m_pool;
 
     bool m_dpd_settings_valid = false;
     dpd_type_t m_dpd_type;
@@ -29,6 +29,7 @@
 #include "Utils.h"
 #include <stdexcept>
 #include <string>
+#include <cstring>
 
 #define MODASSERT(cond) \
     if (not (cond)) { \
@@ -72,11 +73,16 @@ int ModOutput::process(
     return process(dataIn[0]);
 }
 
+/* The input queue holds at most two frames and the end marker pushed by
+ * the destructor, the output queue at most two frames.
+ */
+static const size_t PIPELINE_QUEUE_SIZE = 4;
+
 PipelinedModCodec::PipelinedModCodec() :
     ModCodec(),
     m_number_of_runs(0),
-    m_input_queue(),
-    m_output_queue(),
+    m_input_queue(PIPELINE_QUEUE_SIZE),
+    m_output_queue(PIPELINE_QUEUE_SIZE),
     m_running(false),
     m_thread()
 {
@@ -90,14 +96,15 @@ PipelinedModCodec::~PipelinedModCodec()
     }
 }
 
-void PipelinedModCodec::start_pipeline_thread()
-{
-    m_running = true;
-    m_thread = std::thread(&PipelinedModCodec::process_thread, this);
-}
-
 int PipelinedModCodec::process(Buffer* dataIn, Buffer* dataOut)
 {
+    if (not m_started) {
+        // The derived class is completely constructed by now
+        m_started = true;
+        m_running = true;
+        m_thread = std::thread(&PipelinedModCodec::process_thread, this);
+    }
+
     if (!m_running) {
         return 0;
     }
@@ -125,8 +132,8 @@ int PipelinedModCodec::process(Buffer* dataIn, Buffer* dataOut)
 
 void PipelinedModCodec::process_thread()
 {
-    set_thread_name(name());
     set_realtime_prio(1);
+    set_thread_name(name());
 
     while (m_running) {
         std::shared_ptr<Buffer> dataIn;
@@ -32,7 +32,7 @@
 
 
 #include "Buffer.h"
-#include "ThreadsafeQueue.h"
+#include "SpscQueue.h"
 
 #include <sys/types.h>
 #include <vector>
@@ -83,17 +83,18 @@ public:
     virtual const char* name() = 0;
 
 protected:
-    // Once the instance implementing PipelinedModCodec has been constructed,
-    // it must call start_pipeline_thread()
-    void start_pipeline_thread(void);
     virtual int internal_process(Buffer* const dataIn, Buffer* dataOut) = 0;
 
 private:
     size_t m_number_of_runs;
 
-    ThreadsafeQueue<std::shared_ptr<Buffer> > m_input_queue;
-    ThreadsafeQueue<std::shared_ptr<Buffer> > m_output_queue;
+    SpscQueue<std::shared_ptr<Buffer> > m_input_queue;
+    SpscQueue<std::shared_ptr<Buffer> > m_output_queue;
 
+    // The thread only gets started by the first call to process(), so that
+    // instances used without the pipeline, e.g. through the symbol
+    // streaming or the frame-parallel lanes, do not leave one idle
+    bool m_started = false;
     std::atomic<bool> m_running;
     std::thread m_thread;
     void process_thread(void);
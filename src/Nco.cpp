@@ -0,0 +1,103 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Numerically controlled oscillator shifting a signal in frequency
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Nco.h"
+#include "PcDebug.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+Nco::Nco(double frequency, size_t sampleRate) :
+    m_sampleRate(sampleRate),
+    m_rotation(block_size)
+{
+    PDEBUG("Nco::Nco(%f, %zu) @ %p\n", frequency, sampleRate, this);
+
+    set_frequency(frequency);
+}
+
+void Nco::set_frequency(double frequency)
+{
+    if (std::fabs(frequency) >= m_sampleRate / 2.0) {
+        throw std::invalid_argument("Nco: frequency " +
+                std::to_string(frequency) + " Hz outside of the band of " +
+                std::to_string(m_sampleRate) + " samples per second");
+    }
+
+    m_frequency = frequency;
+    m_step = 2.0 * M_PI * frequency / m_sampleRate;
+    for (size_t i = 0; i < block_size; i++) {
+        m_rotation[i] = std::polar(1.0, m_step * i);
+    }
+}
+
+void Nco::mix(const complexf* in, complexf* out,
+        size_t start, size_t stop, bool accumulate) const
+{
+    const float* r = reinterpret_cast<const float*>(m_rotation.data());
+
+    for (size_t n0 = start; n0 < stop; n0 += block_size) {
+        const size_t count = std::min(block_size, stop - n0);
+
+        const complexf base(std::polar(1.0, m_phase + m_step * n0));
+        const float b_re = base.real();
+        const float b_im = base.imag();
+
+        /* Written out on the real and imaginary parts, because the
+         * complex multiplication of the standard library checks for
+         * infinities and does not get vectorised.
+         */
+        const float* x = reinterpret_cast<const float*>(in + n0);
+        float* y = reinterpret_cast<float*>(out + n0);
+        if (accumulate) {
+            for (size_t i = 0; i < count; i++) {
+                const float w_re = b_re * r[2*i] - b_im * r[2*i+1];
+                const float w_im = b_re * r[2*i+1] + b_im * r[2*i];
+                const float re = x[2*i] * w_re - x[2*i+1] * w_im;
+                const float im = x[2*i] * w_im + x[2*i+1] * w_re;
+                y[2*i] += re;
+                y[2*i+1] += im;
+            }
+        }
+        else {
+            for (size_t i = 0; i < count; i++) {
+                const float w_re = b_re * r[2*i] - b_im * r[2*i+1];
+                const float w_im = b_re * r[2*i+1] + b_im * r[2*i];
+                const float re = x[2*i] * w_re - x[2*i+1] * w_im;
+                const float im = x[2*i] * w_im + x[2*i+1] * w_re;
+                y[2*i] = re;
+                y[2*i+1] = im;
+            }
+        }
+    }
+}
+
+void Nco::advance(size_t num_samples)
+{
+    m_phase = std::fmod(m_phase + m_step * num_samples, 2.0 * M_PI);
+}
+
@@ -0,0 +1,80 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Numerically controlled oscillator shifting a signal in frequency
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <complex>
+#include <vector>
+
+typedef std::complex<float> complexf;
+
+/* The Nco multiplies a signal with exp(j 2 pi f t), where the phase
+ * continues from one frame to the next. Inside a frame, the rotation of
+ * every sample is taken from a table covering one block, and applied
+ * to the phase at the start of the block, computed in double precision
+ * so that the rounding errors do not accumulate.
+ *
+ * Several threads can call mix() on different parts of the same frame.
+ */
+class Nco
+{
+public:
+    /* The frequency is in Hz, and must be within +-sampleRate/2 */
+    Nco(double frequency, size_t sampleRate);
+
+    /* Change the frequency, the phase stays continuous */
+    void set_frequency(double frequency);
+    double frequency() const { return m_frequency; }
+
+    /* Shift the samples [start, stop) of the current frame, and write
+     * them to out, or add them to out if accumulate is set. in and out
+     * can be the same.
+     */
+    void mix(const complexf* in, complexf* out,
+            size_t start, size_t stop, bool accumulate) const;
+
+    /* Continue with the next frame, after num_samples samples */
+    void advance(size_t num_samples);
+
+private:
+    static const size_t block_size = 64;
+
+    size_t m_sampleRate;
+    double m_frequency = 0.0;
+
+    // Phase at the start of the current frame, and phase increment
+    // per sample, in radians
+    double m_phase = 0.0;
+    double m_step = 0.0;
+
+    // exp(j m_step i) for i < block_size
+    std::vector<complexf> m_rotation;
+};
+
@@ -25,6 +25,7 @@
  */
 
 #include "OfdmGenerator.h"
+#include "FftwWisdom.h"
 #include "PcDebug.h"
 
 #include <complex>
@@ -49,14 +50,14 @@ OfdmGenerator::OfdmGenerator(size_t nbSymbols,
                              bool inverse) :
     ModCodec(), RemoteControllable("ofdm"),
     myFftPlan(nullptr),
-    myFftIn(nullptr), myFftOut(nullptr),
     myNbSymbols(nbSymbols),
     myNbCarriers(nbCarriers),
     mySpacing(spacing),
     myCfr(enableCfr),
     myCfrClip(cfrClip),
     myCfrErrorClip(cfrErrorClip),
-    myCfrFft(nullptr)
+    myCfrFft(nullptr),
+    myState(spacing)
 {
     PDEBUG("OfdmGenerator::OfdmGenerator(%zu, %zu, %zu, %s) @ %p\n",
             nbSymbols, nbCarriers, spacing, inverse ? "true" : "false", this);
@@ -100,17 +101,18 @@ OfdmGenerator::OfdmGenerator(size_t nbSymbols,
     PDEBUG("  myZeroDst: %u\n", myZeroDst);
     PDEBUG("  myZeroSize: %u\n", myZeroSize);
 
+    /* The plans are executed on the buffers of any FrameState with
+     * the new-array execute functions. fftwf_malloc gives all of them
+     * the same alignment.
+     */
     const int N = mySpacing; // The size of the FFT
-    myFftIn = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * N);
-    myFftOut = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * N);
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
     myFftPlan = fftwf_plan_dft_1d(N,
-            myFftIn, myFftOut,
+            myState.fftIn, myState.fftOut,
             FFTW_BACKWARD, FFTW_MEASURE);
 
-    myCfrPostClip = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * N);
-    myCfrPostFft = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * N);
     myCfrFft = fftwf_plan_dft_1d(N,
-            myCfrPostClip, myCfrPostFft,
+            myState.cfrPostClip, myState.cfrPostFft,
             FFTW_FORWARD, FFTW_MEASURE);
 
     if (sizeof(complexf) != sizeof(FFT_TYPE)) {
@@ -126,13 +128,7 @@ OfdmGenerator::~OfdmGenerator()
 {
     PDEBUG("OfdmGenerator::~OfdmGenerator() @ %p\n", this);
 
-    if (myFftIn) {
-         fftwf_free(myFftIn);
-    }
-
-    if (myFftOut) {
-         fftwf_free(myFftOut);
-    }
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
 
     if (myFftPlan) {
         fftwf_destroy_plan(myFftPlan);
@@ -143,6 +139,22 @@ OfdmGenerator::~OfdmGenerator()
     }
 }
 
+OfdmGenerator::FrameState::FrameState(size_t spacing)
+{
+    fftIn = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * spacing);
+    fftOut = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * spacing);
+    cfrPostClip = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * spacing);
+    cfrPostFft = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * spacing);
+}
+
+OfdmGenerator::FrameState::~FrameState()
+{
+    fftwf_free(fftIn);
+    fftwf_free(fftOut);
+    fftwf_free(cfrPostClip);
+    fftwf_free(cfrPostFft);
+}
+
 int OfdmGenerator::process(Buffer* const dataIn, Buffer* dataOut)
 {
     PDEBUG("OfdmGenerator::process(dataIn: %p, dataOut: %p)\n",
@@ -150,8 +162,8 @@ int OfdmGenerator::process(Buffer* const dataIn, Buffer* dataOut)
 
     dataOut->setLength(myNbSymbols * mySpacing * sizeof(complexf));
 
-    FFT_TYPE* in = reinterpret_cast<FFT_TYPE*>(dataIn->getData());
-    FFT_TYPE* out = reinterpret_cast<FFT_TYPE*>(dataOut->getData());
+    const complexf* in = reinterpret_cast<const complexf*>(dataIn->getData());
+    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
 
     size_t sizeIn = dataIn->getLength() / sizeof(complexf);
     size_t sizeOut = dataOut->getLength() / sizeof(complexf);
@@ -173,50 +185,69 @@ int OfdmGenerator::process(Buffer* const dataIn, Buffer* dataOut)
                 "OfdmGenerator::process output size not valid!");
     }
 
+    process_symbols(in, out, 0, myNbSymbols);
+
+    return sizeOut;
+}
+
+void OfdmGenerator::process_symbols(const complexf* in, complexf* out,
+        size_t first, size_t count)
+{
+    process_symbols(in, out, first, count, myState);
+}
+
+void OfdmGenerator::process_symbols(const complexf* in, complexf* out,
+        size_t first, size_t count, FrameState& state)
+{
+    FFT_TYPE* fftIn = state.fftIn;
+    FFT_TYPE* fftOut = state.fftOut;
+
     // It is not guaranteed that fftw keeps the FFT input vector intact.
     // That's why we copy it to the reference.
-    std::vector<complexf> reference;
+    std::vector<complexf>& reference = state.cfrReference;
 
     // IFFT output before CFR applied, for MER calc
-    std::vector<complexf> before_cfr;
+    std::vector<complexf>& before_cfr = state.cfrBeforeClip;
 
-    size_t num_clip = 0;
-    size_t num_error_clip = 0;
+    if (first == 0) {
+        state.numClip = 0;
+        state.numErrorClip = 0;
 
-    // For performance reasons, do not calculate MER for every symbol.
-    myMERCalcIndex = (myMERCalcIndex + 1) % myNbSymbols;
+        // For performance reasons, do not calculate MER for every symbol.
+        state.merCalcIndex = (state.merCalcIndex + 1) % myNbSymbols;
+    }
 
-    for (size_t i = 0; i < myNbSymbols; ++i) {
-        myFftIn[0][0] = 0;
-        myFftIn[0][1] = 0;
+    for (size_t i = first; i < first + count; ++i) {
+        fftIn[0][0] = 0;
+        fftIn[0][1] = 0;
 
-        bzero(&myFftIn[myZeroDst], myZeroSize * sizeof(FFT_TYPE));
-        memcpy(&myFftIn[myPosDst], &in[myPosSrc],
+        bzero(&fftIn[myZeroDst], myZeroSize * sizeof(FFT_TYPE));
+        memcpy(&fftIn[myPosDst], &in[myPosSrc],
                 myPosSize * sizeof(FFT_TYPE));
-        memcpy(&myFftIn[myNegDst], &in[myNegSrc],
+        memcpy(&fftIn[myNegDst], &in[myNegSrc],
                 myNegSize * sizeof(FFT_TYPE));
 
         if (myCfr) {
             reference.resize(mySpacing);
-            memcpy(reference.data(), myFftIn, mySpacing * sizeof(FFT_TYPE));
+            memcpy(reference.data(), fftIn, mySpacing * sizeof(FFT_TYPE));
         }
 
-        fftwf_execute(myFftPlan); // IFFT from myFftIn to myFftOut
+        fftwf_execute_dft(myFftPlan, fftIn, fftOut); // IFFT
 
         if (myCfr) {
-            if (myMERCalcIndex == i) {
+            if (state.merCalcIndex == i) {
                 before_cfr.resize(mySpacing);
-                memcpy(before_cfr.data(), myFftOut, mySpacing * sizeof(FFT_TYPE));
+                memcpy(before_cfr.data(), fftOut, mySpacing * sizeof(FFT_TYPE));
             }
 
-            complexf *symbol = reinterpret_cast<complexf*>(myFftOut);
+            complexf *symbol = reinterpret_cast<complexf*>(fftOut);
             /* cfr_one_iteration runs the myFftPlan again at the end, and
-             * therefore writes the output data to myFftOut.
+             * therefore writes the output data to fftOut.
              */
-            const auto stat = cfr_one_iteration(symbol, reference.data());
+            const auto stat = cfr_one_iteration(state, symbol, reference.data());
 
             // i == 0 always zero power, so the MER ends up being NaN
-            if (i > 0 and myMERCalcIndex == i) {
+            if (i > 0 and state.merCalcIndex == i) {
                 /* MER definition, ETSI ETR 290, Annex C
                  *
                  *                       \sum I^2 + Q^2
@@ -238,31 +269,34 @@ int OfdmGenerator::process(Buffer* const dataIn, Buffer* dataOut)
                 // Clamp to 90dB, otherwise the MER average is going to be inf
                 const double mer = sum_delta > 0 ?
                     10.0 * std::log10(sum_iq / sum_delta) : 90;
+                std::lock_guard<std::mutex> lock(myCfrRcMutex);
                 myMERs.push_back(mer);
             }
 
-            num_clip += stat.clip_count;
-            num_error_clip += stat.errclip_count;
+            state.numClip += stat.clip_count;
+            state.numErrorClip += stat.errclip_count;
         }
 
-        memcpy(out, myFftOut, mySpacing * sizeof(FFT_TYPE));
+        memcpy(reinterpret_cast<FFT_TYPE*>(out), fftOut,
+                mySpacing * sizeof(FFT_TYPE));
 
         in += myNbCarriers;
         out += mySpacing;
     }
 
-    if (myCfr) {
+    // The statistics cover a whole transmission frame
+    if (myCfr and first + count == myNbSymbols) {
         std::lock_guard<std::mutex> lock(myCfrRcMutex);
 
         const double num_samps = myNbSymbols * mySpacing;
-        const double clip_ratio = (double)num_clip / num_samps;
+        const double clip_ratio = (double)state.numClip / num_samps;
 
         myClipRatios.push_back(clip_ratio);
         while (myClipRatios.size() > MAX_CLIP_STATS) {
             myClipRatios.pop_front();
         }
 
-        const double errclip_ratio = (double)num_error_clip / num_samps;
+        const double errclip_ratio = (double)state.numErrorClip / num_samps;
         myErrorClipRatios.push_back(errclip_ratio);
         while (myErrorClipRatios.size() > MAX_CLIP_STATS) {
             myErrorClipRatios.pop_front();
@@ -272,12 +306,10 @@ int OfdmGenerator::process(Buffer* const dataIn, Buffer* dataOut)
             myMERs.pop_front();
         }
     }
-
-    return sizeOut;
 }
 
 OfdmGenerator::cfr_iter_stat_t OfdmGenerator::cfr_one_iteration(
-        complexf *symbol, const complexf *reference)
+        FrameState& state, complexf *symbol, const complexf *reference)
 {
     // use std::norm instead of std::abs to avoid calculating the
     // square roots
@@ -299,8 +331,9 @@ OfdmGenerator::cfr_iter_stat_t OfdmGenerator::cfr_one_iteration(
     }
 
     // Take FFT of our clipped signal
-    memcpy(myCfrPostClip, symbol, mySpacing * sizeof(FFT_TYPE));
-    fftwf_execute(myCfrFft); // FFT from myCfrPostClip to myCfrPostFft
+    memcpy(state.cfrPostClip, symbol, mySpacing * sizeof(FFT_TYPE));
+    // FFT from cfrPostClip to cfrPostFft
+    fftwf_execute_dft(myCfrFft, state.cfrPostClip, state.cfrPostFft);
 
     // Calculate the error in frequency domain by subtracting our reference
     // and clip it to myCfrErrorClip. By adding this clipped error signal
@@ -317,7 +350,7 @@ OfdmGenerator::cfr_iter_stat_t OfdmGenerator::cfr_one_iteration(
         // (calculated with IFFT-clip-FFT) against reference (input to
         // the IFFT), we need to divide by our FFT size.
         const complexf constellation_point =
-            reinterpret_cast<complexf*>(myCfrPostFft)[i] / (float)mySpacing;
+            reinterpret_cast<complexf*>(state.cfrPostFft)[i] / (float)mySpacing;
 
         complexf error = reference[i] - constellation_point;
 
@@ -331,12 +364,12 @@ OfdmGenerator::cfr_iter_stat_t OfdmGenerator::cfr_one_iteration(
 
         // Update the input to the FFT directly to avoid another copy for the
         // subsequence IFFT
-        complexf *fft_in = reinterpret_cast<complexf*>(myFftIn);
+        complexf *fft_in = reinterpret_cast<complexf*>(state.fftIn);
         fft_in[i] = constellation_point + error;
     }
 
     // Run our error-compensated symbol through the IFFT again
-    fftwf_execute(myFftPlan); // IFFT from myFftIn to myFftOut
+    fftwf_execute_dft(myFftPlan, state.fftIn, state.fftOut);
 
     return ret;
 }
@@ -57,6 +57,48 @@ class OfdmGenerator : public ModCodec, public RemoteControllable
         int process(Buffer* const dataIn, Buffer* dataOut) override;
         const char* name() override { return "OfdmGenerator"; }
 
+        /* The FFT buffers and the CFR counters of the frame being
+         * transformed. Threads that transform different frames at the
+         * same time each need their own.
+         */
+        class FrameState
+        {
+            public:
+                FrameState(size_t spacing);
+                ~FrameState();
+                FrameState(const FrameState&) = delete;
+                FrameState& operator=(const FrameState&) = delete;
+
+            private:
+                friend class OfdmGenerator;
+
+                fftwf_complex *fftIn, *fftOut;
+                fftwf_complex *cfrPostClip, *cfrPostFft;
+
+                // CFR scratch buffers and clip counters
+                std::vector<complexf> cfrReference;
+                std::vector<complexf> cfrBeforeClip;
+                size_t numClip = 0;
+                size_t numErrorClip = 0;
+                size_t merCalcIndex = 0;
+        };
+
+        /* Transform count symbols of myNbCarriers carriers into count
+         * symbols of mySpacing samples. first is the index of the first
+         * symbol in the transmission frame. The CFR statistics are
+         * updated once the last symbol of the frame has been processed.
+         */
+        void process_symbols(const complexf* in, complexf* out,
+                size_t first, size_t count);
+
+        /* Same, using the given state instead of the one of the
+         * OfdmGenerator, and can be called concurrently.
+         */
+        void process_symbols(const complexf* in, complexf* out,
+                size_t first, size_t count, FrameState& state);
+
+        size_t spacing() const { return mySpacing; }
+
         /* Functions for the remote control */
         /* Base function to set parameters. */
         virtual void set_parameter(
@@ -73,11 +115,10 @@ class OfdmGenerator : public ModCodec, public RemoteControllable
             size_t errclip_count = 0;
         };
 
-        cfr_iter_stat_t cfr_one_iteration(
+        cfr_iter_stat_t cfr_one_iteration(FrameState& state,
                 complexf *symbol, const complexf *reference);
 
         fftwf_plan myFftPlan;
-        fftwf_complex *myFftIn, *myFftOut;
         const size_t myNbSymbols;
         const size_t myNbCarriers;
         const size_t mySpacing;
@@ -95,14 +136,13 @@ class OfdmGenerator : public ModCodec, public RemoteControllable
         float myCfrClip;
         float myCfrErrorClip;
         fftwf_plan myCfrFft;
-        fftwf_complex *myCfrPostClip;
-        fftwf_complex *myCfrPostFft;
 
-        // Statistics for CFR
+        // The state used by process() and process_symbols() without state
+        FrameState myState;
+
+        // Statistics for CFR, protected by myCfrRcMutex
         std::deque<double> myClipRatios;
         std::deque<double> myErrorClipRatios;
-
-        size_t myMERCalcIndex = 0;
         std::deque<double> myMERs;
 };
 
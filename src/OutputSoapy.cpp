@@ -109,6 +109,12 @@ OutputSoapy::~OutputSoapy()
     }
 }
 
+// One more slot than FRAMES_MAX_SIZE for the end marker pushed by stop()
+SoapyWorker::SoapyWorker() :
+    queue(FRAMES_MAX_SIZE + 1)
+{
+}
+
 void SoapyWorker::stop()
 {
     running = false;
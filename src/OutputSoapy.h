@@ -47,7 +47,7 @@ DESCRIPTION:
 #include "ModPlugin.h"
 #include "EtiReader.h"
 #include "RemoteControl.h"
-#include "ThreadsafeQueue.h"
+#include "SpscQueue.h"
 
 typedef std::complex<float> complexf;
 
@@ -78,13 +78,13 @@ struct SoapyWorkerFrameData {
 class SoapyWorker
 {
     public:
-        ThreadsafeQueue<SoapyWorkerFrameData> queue;
+        SpscQueue<SoapyWorkerFrameData> queue;
         SoapySDR::Device *m_device;
         std::atomic<bool> running;
         size_t underflows;
         size_t overflows;
 
-        SoapyWorker() {}
+        SoapyWorker();
         SoapyWorker(const SoapyWorker&) = delete;
         SoapyWorker operator=(const SoapyWorker&) = delete;
         ~SoapyWorker() { stop(); }
@@ -875,6 +875,8 @@ void OutputUHD::tx_frame(const struct UHDWorkerFrameData *frame, bool ts_update)
 
 void OutputUHD::print_async_thread()
 {
+    set_thread_name("uhdasync");
+
     while (running.load()) {
         uhd::async_metadata_t async_md;
         if (myUsrp->get_device()->recv_async_msg(async_md, 1)) {
@@ -0,0 +1,150 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    A persistent thread pool that splits loops over its threads
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelFor.h"
+#include "Futex.h"
+#include "PcDebug.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+ParallelFor::ParallelFor(size_t num_workers,
+        const std::string& name,
+        const std::vector<int>& cpus) :
+    m_name(name),
+    m_exceptions(num_workers)
+{
+    PDEBUG("ParallelFor::ParallelFor(%zu, %s) @ %p\n",
+            num_workers, name.c_str(), this);
+
+    for (size_t i = 0; i < num_workers; i++) {
+        m_threads.emplace_back(&ParallelFor::worker, this, i);
+
+        if (not cpus.empty()) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpus[i % cpus.size()], &cpuset);
+
+            const int ret = pthread_setaffinity_np(
+                    m_threads.back().native_handle(),
+                    sizeof(cpu_set_t), &cpuset);
+            if (ret != 0) {
+                etiLog.level(warn) << m_name << ": could not pin worker " <<
+                    i << " to CPU " << cpus[i % cpus.size()] << ": " <<
+                    strerror(ret);
+            }
+        }
+    }
+}
+
+ParallelFor::~ParallelFor()
+{
+    m_terminate.store(true);
+    event_notify(m_generation, m_generation_waiting);
+
+    for (auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void ParallelFor::run(size_t size, const range_function_t& fn,
+        size_t granularity)
+{
+    std::lock_guard<std::mutex> lock(m_run_mutex);
+
+    const size_t num_workers = m_threads.size();
+    const size_t step =
+        (size / concurrency() / granularity) * granularity;
+
+    if (num_workers == 0 or step == 0) {
+        fn(0, size);
+        return;
+    }
+
+    m_fn = &fn;
+    m_step = step;
+    m_pending.store(num_workers);
+    event_notify(m_generation, m_generation_waiting);
+
+    std::exception_ptr caller_exception;
+    try {
+        fn(num_workers * step, size);
+    }
+    catch (...) {
+        caller_exception = std::current_exception();
+    }
+
+    event_wait(m_done_event, m_done_waiting, [&]() {
+            return m_pending.load(std::memory_order_acquire) == 0; });
+
+    m_fn = nullptr;
+
+    if (caller_exception) {
+        std::rethrow_exception(caller_exception);
+    }
+
+    for (auto& e : m_exceptions) {
+        if (e) {
+            std::exception_ptr worker_exception;
+            std::swap(worker_exception, e);
+            std::rethrow_exception(worker_exception);
+        }
+    }
+}
+
+void ParallelFor::worker(size_t index)
+{
+    set_thread_name(m_name.c_str());
+
+    // No run can start before the constructor has returned
+    uint32_t generation = 0;
+
+    while (true) {
+        event_wait(m_generation, m_generation_waiting, [&]() {
+                return m_generation.load(std::memory_order_acquire) !=
+                    generation; });
+        generation = m_generation.load(std::memory_order_acquire);
+
+        if (m_terminate.load()) {
+            break;
+        }
+
+        try {
+            (*m_fn)(index * m_step, (index + 1) * m_step);
+        }
+        catch (...) {
+            m_exceptions[index] = std::current_exception();
+        }
+
+        if (m_pending.fetch_sub(1) == 1) {
+            event_notify(m_done_event, m_done_waiting);
+        }
+    }
+}
+
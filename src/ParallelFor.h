@@ -0,0 +1,103 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    A persistent thread pool that splits loops over its threads
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ParallelFor runs a loop over [0, size) on a set of worker threads
+ * and the calling thread, each taking one contiguous range. The workers
+ * are created once and sleep between two runs, the hand-off and the
+ * completion are signalled through a barrier that spins before it
+ * sleeps, see Futex.h.
+ *
+ * Blocks that process large frames sample by sample (MemlessPoly,
+ * FIRFilter) run on a pool, each one its own or one shared by several
+ * blocks. The runs of the callers of a shared pool are serialised, each
+ * run gets all the workers.
+ */
+class ParallelFor
+{
+public:
+    using range_function_t = std::function<void(size_t start, size_t stop)>;
+
+    /* Create num_workers threads besides the calling thread. If cpus is
+     * not empty, the workers are pinned to these CPUs in turn.
+     */
+    ParallelFor(size_t num_workers,
+            const std::string& name,
+            const std::vector<int>& cpus = {});
+    ParallelFor(const ParallelFor&) = delete;
+    ParallelFor& operator=(const ParallelFor&) = delete;
+    ~ParallelFor();
+
+    /* Number of threads taking part in a run, including the caller */
+    size_t concurrency() const { return m_threads.size() + 1; }
+
+    /* Call fn(start, stop) for concurrency() ranges covering [0, size)
+     * and wait until all of them are done. All ranges but the last,
+     * which the calling thread takes, start at a multiple of granularity.
+     * An exception thrown in a worker is rethrown here.
+     */
+    void run(size_t size, const range_function_t& fn,
+            size_t granularity = 1);
+
+private:
+    void worker(size_t index);
+
+    std::vector<std::thread> m_threads;
+    std::string m_name;
+
+    // Serialises the runs, the pool is not reentrant
+    std::mutex m_run_mutex;
+
+    // The current job, valid while m_pending is non-zero
+    const range_function_t *m_fn = nullptr;
+    size_t m_step = 0;
+    std::vector<std::exception_ptr> m_exceptions;
+
+    std::atomic<bool> m_terminate{false};
+
+    // Incremented to start a run
+    std::atomic<uint32_t> m_generation{0};
+    std::atomic<uint32_t> m_generation_waiting{0};
+
+    // Workers that have not finished the current run
+    std::atomic<uint32_t> m_pending{0};
+    std::atomic<uint32_t> m_done_event{0};
+    std::atomic<uint32_t> m_done_waiting{0};
+};
+
@@ -26,6 +26,8 @@
 #include <stdexcept>
 #include <complex>
 #include <string.h>
+#include <map>
+#include <mutex>
 
 typedef std::complex<float> complexf;
 
@@ -83,8 +85,26 @@ PhaseReference::PhaseReference(unsigned int dabmode) :
         throw std::runtime_error(
                 "PhaseReference::PhaseReference DAB mode not valid!");
     }
-    d_dataIn.resize(d_carriers);
-    fillData();
+    d_dataIn = reference(d_dabmode, d_carriers);
+}
+
+
+std::shared_ptr<const std::vector<complexf> > PhaseReference::reference(
+        unsigned int dabmode, size_t carriers)
+{
+    static std::mutex cache_mutex;
+    static std::map<unsigned int, std::shared_ptr<const std::vector<complexf> > >
+        cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto& data = cache[dabmode];
+    if (not data) {
+        std::vector<complexf> symbol(carriers);
+        fillData(dabmode, symbol);
+        data = std::make_shared<const std::vector<complexf> >(
+                std::move(symbol));
+    }
+    return data;
 }
 
 
@@ -105,7 +125,8 @@ complexf convert(uint8_t data) {
 }
 
 
-void PhaseReference::fillData()
+void PhaseReference::fillData(unsigned int dabmode,
+        std::vector<complexf>& data)
 {
     size_t index;
     size_t offset;
@@ -146,20 +167,15 @@ void PhaseReference::fillData()
         },
     };
 
-    if (d_dabmode > 3) {
+    if (dabmode > 3) {
         throw std::runtime_error(
                 "PhaseReference::fillData invalid DAB mode!");
     }
 
-    if (d_dataIn.size() != d_carriers) {
-        throw std::runtime_error(
-                "PhaseReference::fillData d_dataIn has incorrect size!");
-    }
-
-    for (index = 0, offset = 0; index < d_dataIn.size(); ++offset) {
+    for (index = 0, offset = 0; index < data.size(); ++offset) {
         for (k = 0; k < 32; ++k) {
-            d_dataIn[index++] = convert(d_h[table[d_dabmode][offset][0]][k]
-                    + table[d_dabmode][offset][1]);
+            data[index++] = convert(d_h[table[dabmode][offset][0]][k]
+                    + table[dabmode][offset][1]);
         }
     }
 }
@@ -169,7 +185,7 @@ int PhaseReference::process(Buffer* dataOut)
 {
     PDEBUG("PhaseReference::process(dataOut: %p)\n", dataOut);
 
-    dataOut->setData(&d_dataIn[0], d_carriers * sizeof(complexf));
+    dataOut->setData(d_dataIn->data(), d_carriers * sizeof(complexf));
 
     return 1;
 }
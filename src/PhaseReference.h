@@ -34,6 +34,7 @@
 
 #include <sys/types.h>
 #include <complex>
+#include <memory>
 #include <vector>
 
 
@@ -48,13 +49,20 @@ public:
     int process(Buffer* dataOut);
     const char* name() { return "PhaseReference"; }
 
+    /* The phase reference symbol of the given mode (0 for mode 4). It is
+     * computed once and shared by all instances, also across modulators.
+     */
+    static std::shared_ptr<const std::vector<std::complex<float> > >
+        reference(unsigned int dabmode, size_t carriers);
+
 protected:
     unsigned int d_dabmode;
     size_t d_carriers;
     size_t d_num;
     const static unsigned char d_h[4][32];
-    std::vector<std::complex<float> > d_dataIn;
+    std::shared_ptr<const std::vector<std::complex<float> > > d_dataIn;
 
-    void fillData();
+    static void fillData(unsigned int dabmode,
+            std::vector<std::complex<float> >& data);
 };
 
@@ -24,101 +24,128 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdexcept>
+#include <map>
+#include <mutex>
+#include <tuple>
 
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif
 
-PrbsGenerator::PrbsGenerator(size_t framesize, uint32_t polynomial,
-        uint32_t accum, size_t init) :
-    ModPlugin(),
-    d_framesize(framesize),
-    d_polynomial(polynomial),
-    d_accum(accum),
-    d_accum_init(accum),
-    d_init(init)
-{
-    PDEBUG("PrbsGenerator::PrbsGenerator(%zu, %u, %u, %zu) @ %p\n",
-            framesize, polynomial, accum, init, this);
-
-    gen_prbs_table();
-    gen_weight_table();
-}
+namespace {
 
-
-PrbsGenerator::~PrbsGenerator()
+/*
+ * Generate a parity check for a 32-bit word.
+ */
+uint32_t parity_check(uint32_t prbs_accum)
 {
-    PDEBUG("PrbsGenerator::~PrbsGenerator() @ %p\n", this);
-
+    uint32_t mask=1UL, parity=0UL;
+    int i;
+    for (i = 0;  i < 32;  ++i) {
+        parity ^= ((prbs_accum & mask) != 0UL);
+        mask <<= 1;
+    }
+    return parity;
 }
 
 
 /*
- * Generate a table of matrix products to update a 32-bit PRBS generator.
+ * Generate the sequence, updating a 32-bit PRBS generator eight bits at
+ * a time using a table of matrix products.
  */
-void PrbsGenerator::gen_prbs_table()
+std::vector<uint8_t> generate(size_t framesize, uint32_t polynomial,
+        uint32_t accum_init, size_t init)
 {
-    int i;
-    for (i = 0;  i < 4;  ++i) {
-        int j;
-        for (j = 0;  j < 256;  ++j) {
+    uint32_t prbs_table[4][256];
+    for (int i = 0;  i < 4;  ++i) {
+        for (int j = 0;  j < 256;  ++j) {
             uint32_t prbs_accum = ((uint32_t)j << (i * 8));
-            int k;
-            for (k = 0;  k < 8;  ++k) {
+            for (int k = 0;  k < 8;  ++k) {
                 prbs_accum = (prbs_accum << 1)
-                                ^ parity_check(prbs_accum & d_polynomial);
+                                ^ parity_check(prbs_accum & polynomial);
             }
-            d_prbs_table[i][j] = (prbs_accum & 0xff);
+            prbs_table[i][j] = (prbs_accum & 0xff);
         }
     }
-}
 
+    uint32_t accum;
+    if (accum_init) {
+        accum = accum_init;
+    }
+    else {
+        accum = 0;
+        while (accum < polynomial) {
+            accum <<= 1;
+            accum |= 1;
+        }
+    }
 
-/*
- * Generate the weight table.
- */
-void PrbsGenerator::gen_weight_table()
-{
-    int i;
-    for (i = 0;  i < 256;  ++i) {
-        unsigned char mask=1U, ones_count = 0U;
-        int j;
-        for (j = 0;  j < 8;  ++j) {
-            ones_count += ((i & mask) != 0U);
-            mask = mask << 1;
+    std::vector<uint8_t> out(framesize);
+    size_t i = 0;
+    while (i < init and i < framesize) {
+        out[i++] = 0xff;
+    }
+
+    for (; i < framesize; ++i) {
+        unsigned char acc_lsb = 0;
+        for (int j = 0; j < 4; ++j) {
+            acc_lsb ^= prbs_table[j][(accum >> (j * 8)) & 0xff];
+        }
+        accum = (accum << 8) ^ ((uint32_t)acc_lsb);
+
+        if ((accum_init == 0xa9) && (i % 188 == 0)) { // DVB energy dispersal
+            out[i] = 0;
+        }
+        else {
+            out[i] = (unsigned char)(accum & 0xff);
         }
-        d_weight[i] = ones_count;
     }
+
+    return out;
 }
 
+} // anonymous namespace
 
-/*
- * Generate a parity check for a 32-bit word.
- */
-uint32_t PrbsGenerator::parity_check(uint32_t prbs_accum)
+
+std::shared_ptr<const std::vector<uint8_t> > PrbsGenerator::sequence(
+        size_t framesize, uint32_t polynomial, uint32_t accum, size_t init)
 {
-    uint32_t mask=1UL, parity=0UL;
-    int i;
-    for (i = 0;  i < 32;  ++i) {
-        parity ^= ((prbs_accum & mask) != 0UL);
-        mask <<= 1;
+    typedef std::tuple<uint32_t, uint32_t, size_t, size_t> key_t;
+    static std::mutex cache_mutex;
+    static std::map<key_t, std::shared_ptr<const std::vector<uint8_t> > >
+        cache;
+
+    const key_t key(polynomial, accum, init, framesize);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto& seq = cache[key];
+    if (not seq) {
+        PDEBUG("PrbsGenerator::sequence generating (%zu, %u, %u, %zu)\n",
+                framesize, polynomial, accum, init);
+        seq = std::make_shared<const std::vector<uint8_t> >(
+                generate(framesize, polynomial, accum, init));
     }
-    return parity;
+    return seq;
 }
 
 
-/*
- * Update a 32-bit PRBS generator eight bits at a time.
- */
-uint32_t PrbsGenerator::update_prbs()
+PrbsGenerator::PrbsGenerator(size_t framesize, uint32_t polynomial,
+        uint32_t accum, size_t init) :
+    ModPlugin(),
+    d_framesize(framesize),
+    d_sequence(sequence(framesize, polynomial, accum, init))
 {
-    unsigned char acc_lsb = 0;
-    int i;
-    for (i = 0; i < 4; ++i) {
-//        PDEBUG("0x%x = 0x%x ^ 0x%x\n",
-//            acc_lsb ^ d_prbs_table [i][(d_accum >> (i * 8)) & 0xff],
-//            acc_lsb, d_prbs_table [i][(d_accum >> (i * 8)) & 0xff]);
-        acc_lsb ^= d_prbs_table[i][(d_accum >> (i * 8)) & 0xff];
-    }
-    return (d_accum << 8) ^ ((uint32_t)acc_lsb);
+    PDEBUG("PrbsGenerator::PrbsGenerator(%zu, %u, %u, %zu) @ %p\n",
+            framesize, polynomial, accum, init, this);
+}
+
+
+PrbsGenerator::~PrbsGenerator()
+{
+    PDEBUG("PrbsGenerator::~PrbsGenerator() @ %p\n", this);
+
 }
 
 
@@ -138,37 +165,12 @@ int PrbsGenerator::process(
     }
     dataOut[0]->setLength(d_framesize);
     unsigned char* out = reinterpret_cast<unsigned char*>(dataOut[0]->getData());
+    const unsigned char* seq = d_sequence->data();
 
-    // Initialization
-    if (d_accum_init) {
-        d_accum = d_accum_init;
+    if (dataIn.empty()) {
+        memcpy(out, seq, d_framesize);
     }
     else {
-        d_accum = 0;
-        while (d_accum < d_polynomial) {
-            d_accum <<= 1;
-            d_accum |= 1;
-        }
-    }
-    //PDEBUG("Polynomial: 0x%x\n", d_polynomial);
-    //PDEBUG("Init accum: 0x%x\n", d_accum);
-    size_t i = 0;
-    while (i < d_init) {
-        out[i++] = 0xff;
-    }
-
-    for (; i < d_framesize; ++i) {
-        d_accum = update_prbs();
-        if ((d_accum_init == 0xa9) && (i % 188 == 0)) { // DVB energy dispersal
-            out[i] = 0;
-        }
-        else {
-            out[i] = (unsigned char)(d_accum & 0xff);
-        }
-        //PDEBUG("accum: 0x%x\n", d_accum);
-    }
-
-    if (not dataIn.empty()) {
         PDEBUG(" mixing input\n");
         const unsigned char* in =
             reinterpret_cast<const unsigned char*>(dataIn[0]->getData());
@@ -178,8 +180,17 @@ int PrbsGenerator::process(
             throw std::runtime_error("PrbsGenerator::process "
                     "input size is not equal to output size!\n");
         }
-        for (size_t i = 0; i < dataOut[0]->getLength(); ++i) {
-            out[i] ^= in[i];
+
+        size_t i = 0;
+#ifdef __SSE2__
+        for (; i + 16 <= d_framesize; i += 16) {
+            const __m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+            const __m128i b = _mm_loadu_si128((const __m128i*)(seq + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(a, b));
+        }
+#endif
+        for (; i < d_framesize; ++i) {
+            out[i] = in[i] ^ seq[i];
         }
     }
 
@@ -33,6 +33,8 @@
 #include "ModPlugin.h"
 #include <sys/types.h>
 #include <stdint.h>
+#include <memory>
+#include <vector>
 
 /* The PrbsGenerator can work as a ModInput generating a Prbs
  * sequence from the given parameters only, or as a ModCodec
@@ -41,25 +43,9 @@
 class PrbsGenerator : public ModPlugin
 {
 private:
-    uint32_t parity_check(uint32_t prbs_accum);
-    void gen_prbs_table();
-    uint32_t update_prbs();
-    void gen_weight_table();
-
     size_t d_framesize;
-    // table of matrix products used to update a 32-bit PRBS generator
-    uint32_t d_prbs_table [4][256];
-    // table of weights for 8-bit bytes
-    unsigned char d_weight[256];
-    // PRBS polynomial generator
-    uint32_t d_polynomial;
-    // PRBS generator polarity mask
-    unsigned char d_polarity_mask;
-    // PRBS accumulator
-    uint32_t d_accum;
-    uint32_t d_accum_init;
-    // Initialization size
-    size_t d_init;
+    // Shared sequence, see sequence()
+    std::shared_ptr<const std::vector<uint8_t> > d_sequence;
 
 public:
     PrbsGenerator(size_t framesize, uint32_t polynomial, uint32_t accum = 0,
@@ -68,5 +54,14 @@ public:
 
     int process(std::vector<Buffer*> dataIn, std::vector<Buffer*> dataOut);
     const char* name() { return "PrbsGenerator"; }
+
+    /* The sequence only depends on its parameters, and is the same for
+     * every frame. It is generated on first use and kept in a
+     * process-wide cache, shared by all users asking for the same
+     * parameters.
+     */
+    static std::shared_ptr<const std::vector<uint8_t> > sequence(
+            size_t framesize, uint32_t polynomial, uint32_t accum = 0,
+            size_t init = 0);
 };
 
@@ -57,15 +57,13 @@ PuncturingEncoder::PuncturingEncoder(
 void PuncturingEncoder::adjust_item_size()
 {
     PDEBUG("PuncturingEncoder::adjust_item_size()\n");
-    int in_size = 0;
-    int out_size = 0;
-    int length = 0;
+    size_t in_size = 0;
+    size_t out_size = 0;
 
     for (const auto& rule : d_rules) {
-        for (length = rule.length(); length > 0; length -= 4) {
-            out_size += rule.bit_size();
-            in_size += 4;
-        }
+        const size_t words = (rule.length() + 3) / 4;
+        out_size += words * rule.bit_size();
+        in_size += words * 4;
     }
 
     if (d_tail_rule) {
@@ -76,6 +74,13 @@ void PuncturingEncoder::adjust_item_size()
     d_in_block_size = in_size;
     d_out_block_size = (out_size + 7) / 8;
 
+    if (d_num_cu > 0 and d_num_cu * 8 == d_out_block_size + 1) {
+        /* EN 300 401 Table 31 in 11.3.1 UEP coding specifies
+         * that we need one byte of padding
+         */
+        d_out_block_size = d_num_cu * 8;
+    }
+
     PDEBUG(" Puncturing encoder ratio (out/in): %zu / %zu\n",
             d_out_block_size, d_in_block_size);
 }
@@ -93,118 +98,76 @@ void PuncturingEncoder::append_rule(const PuncturingRule& rule)
 void PuncturingEncoder::append_tail_rule(const PuncturingRule& rule)
 {
     PDEBUG("append_tail_rule(rule(%zu, 0x%x))\n", rule.length(), rule.pattern());
+    if (rule.length() > 4) {
+        throw std::invalid_argument(
+                "PuncturingEncoder tail rule longer than 4 bytes");
+    }
     d_tail_rule = rule;
+    d_tail_word_rule = PuncturingRule(rule.length(),
+            rule.pattern() << (8 * (4 - rule.length())));
 
     adjust_item_size();
 }
 
 
+namespace {
+
+/* Reads the input buffer for the generic puncture() function */
+struct BufferSource {
+    BufferSource(const uint8_t* in, size_t tail_length) :
+        in(in), tail_length(tail_length) {}
+
+    uint32_t next() {
+        const uint32_t word = ((uint32_t)in[0] << 24) | (in[1] << 16) |
+            (in[2] << 8) | in[3];
+        in += 4;
+        return word;
+    }
+
+    uint32_t tail() {
+        uint32_t word = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            word <<= 8;
+            if (i < tail_length) {
+                word |= in[i];
+            }
+        }
+        return word;
+    }
+
+    const uint8_t* in;
+    size_t tail_length;
+};
+
+} // anonymous namespace
+
+
 int PuncturingEncoder::process(Buffer* const dataIn, Buffer* dataOut)
 {
     PDEBUG("PuncturingEncoder::process"
             "(dataIn: %p, dataOut: %p)\n",
             dataIn, dataOut);
-    size_t in_count = 0;
-    size_t out_count = 0;
-    size_t bit_count = 0;
-    size_t length;
-    unsigned char data;
-    uint32_t mask;
-    uint32_t pattern;
-    auto rule_it = d_rules.begin();
     PDEBUG(" in block size: %zu\n", d_in_block_size);
     PDEBUG(" out block size: %zu\n", d_out_block_size);
 
-    if (d_num_cu > 0) {
-        if (d_num_cu * 8 == d_out_block_size + 1) {
-            /* EN 300 401 Table 31 in 11.3.1 UEP coding specifies
-             * that we need one byte of padding
-             */
-            d_out_block_size = d_num_cu * 8;
-        }
-
-        if (d_num_cu * 8 != d_out_block_size) {
-            throw std::runtime_error(
-                    "PuncturingEncoder encoder initialisation failed. "
-                    " CU: " + std::to_string(d_num_cu) +
-                    " block_size: " + std::to_string(d_out_block_size));
-        }
+    if (d_num_cu > 0 and d_num_cu * 8 != d_out_block_size) {
+        throw std::runtime_error(
+                "PuncturingEncoder encoder initialisation failed. "
+                " CU: " + std::to_string(d_num_cu) +
+                " block_size: " + std::to_string(d_out_block_size));
     }
 
-    dataOut->setLength(d_out_block_size);
-    const unsigned char* in = reinterpret_cast<const unsigned char*>(dataIn->getData());
-    unsigned char* out = reinterpret_cast<unsigned char*>(dataOut->getData());
-
     if (dataIn->getLength() != d_in_block_size) {
         throw std::runtime_error(
                 "PuncturingEncoder::process wrong input size");
     }
 
-    if (d_tail_rule) {
-        d_in_block_size -= d_tail_rule->length();
-    }
-    while (in_count < d_in_block_size) {
-        for (length = rule_it->length(); length > 0; length -= 4) {
-            mask = 0x80000000;
-            pattern = rule_it->pattern();
-            for (int i = 0; i < 4; ++i) {
-                data = in[in_count++];
-                for (int j = 0; j < 8; ++j) {
-                    if (pattern & mask) {
-                        out[out_count] <<= 1;
-                        out[out_count] |= data >> 7;
-                        if (++bit_count == 8) {
-                            bit_count = 0;
-                            ++out_count;
-                        }
-                    }
-                    data <<= 1;
-                    mask >>= 1;
-                }
-            }
-        }
-        if (++rule_it == d_rules.end()) {
-            rule_it = d_rules.begin();
-        }
-    }
-    if (d_tail_rule) {
-        d_in_block_size += d_tail_rule->length();
-        mask = 0x800000;
-        pattern = d_tail_rule->pattern();
-        length = d_tail_rule->length();
-        for (size_t i = 0; i < length; ++i) {
-            data = in[in_count++];
-            for (int j = 0; j < 8; ++j) {
-                if (pattern & mask) {
-                    out[out_count] <<= 1;
-                    out[out_count] |= data >> 7;
-                    if (++bit_count == 8) {
-                        bit_count = 0;
-                        ++out_count;
-                    }
-                }
-                data <<= 1;
-                mask >>= 1;
-            }
-        }
-    }
-    while (bit_count) {
-        out[out_count] <<= 1;
-        if (++bit_count == 8) {
-            bit_count = 0;
-            ++out_count;
-        }
-    }
-
-    for (size_t i = out_count; i < dataOut->getLength(); ++i) {
-        out[out_count++] = 0;
-    }
+    dataOut->setLength(d_out_block_size);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
+    uint8_t* out = reinterpret_cast<uint8_t*>(dataOut->getData());
 
-    assert(out_count == dataOut->getLength());
-    if (out_count != dataOut->getLength()) {
-        throw std::runtime_error("PuncturingEncoder::process output size "
-                "does not correspond!");
-    }
+    BufferSource source(in, d_tail_rule ? d_tail_rule->length() : 0);
+    puncture(source, out);
 
     return d_out_block_size;
 }
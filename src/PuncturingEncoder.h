@@ -37,6 +37,7 @@
 #include <vector>
 #include <string>
 #include <sys/types.h>
+#include <stdint.h>
 #include <boost/optional.hpp>
 
 class PuncturingEncoder : public ModCodec
@@ -63,6 +64,21 @@ public:
     size_t getInputSize() { return d_in_block_size; }
     size_t getOutputSize() { return d_out_block_size; }
 
+    /* Puncture one frame of getInputSize() bytes into out, which must hold
+     * getOutputSize() bytes. The input is read from source, which must
+     * provide two functions:
+     *  uint32_t next(): returns the next four input bytes, the first one in
+     *                   the MSB. Called getInputSize()/4 times, excluding
+     *                   the tail.
+     *  uint32_t tail(): returns the tail bytes, left-aligned in the same
+     *                   way. Called once at the end if there is a tail rule.
+     *
+     * This function does not modify the encoder and can be called from
+     * several threads.
+     */
+    template<typename Source>
+    void puncture(Source& source, uint8_t* out) const;
+
 private:
     size_t d_num_cu;
     size_t d_in_block_size;
@@ -70,6 +86,47 @@ private:
     std::vector<PuncturingRule> d_rules;
     boost::optional<PuncturingRule> d_tail_rule;
 
+    // Tail rule with the pattern aligned to the MSB of a 32-bit word
+    boost::optional<PuncturingRule> d_tail_word_rule;
+
     void adjust_item_size();
 };
 
+template<typename Source>
+void PuncturingEncoder::puncture(Source& source, uint8_t* out) const
+{
+    uint8_t* const end = out + d_out_block_size;
+
+    // Punctured bits not yet written, in the acc_bits LSBs of acc
+    uint64_t acc = 0;
+    unsigned acc_bits = 0;
+
+    auto append = [&](uint32_t bits, unsigned num_bits) {
+        acc = (acc << num_bits) | bits;
+        acc_bits += num_bits;
+        while (acc_bits >= 8) {
+            acc_bits -= 8;
+            *(out++) = acc >> acc_bits;
+        }
+    };
+
+    for (const auto& rule : d_rules) {
+        const size_t num_bits = rule.bit_size();
+        for (size_t words = (rule.length() + 3) / 4; words > 0; --words) {
+            append(rule.puncture(source.next()), num_bits);
+        }
+    }
+
+    if (d_tail_word_rule) {
+        append(d_tail_word_rule->puncture(source.tail()),
+                d_tail_word_rule->bit_size());
+    }
+
+    if (acc_bits) {
+        *(out++) = acc << (8 - acc_bits);
+    }
+
+    while (out < end) {
+        *(out++) = 0;
+    }
+}
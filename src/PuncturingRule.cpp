@@ -22,21 +22,46 @@
 #include "PcDebug.h"
 #include "PuncturingRule.h"
 #include <stdio.h>
+#include <vector>
+
+/* Table of the packed bits of every byte value under every byte mask,
+ * indexed by (mask << 8) | value, shared by all rules.
+ */
+static std::vector<uint8_t> build_byte_lut()
+{
+    std::vector<uint8_t> lut(256 * 256);
+    for (size_t mask = 0; mask < 256; ++mask) {
+        for (size_t value = 0; value < 256; ++value) {
+            uint8_t bits = 0;
+            for (int j = 7; j >= 0; --j) {
+                if (mask & (1 << j)) {
+                    bits = (bits << 1) | ((value >> j) & 1);
+                }
+            }
+            lut[(mask << 8) | value] = bits;
+        }
+    }
+    return lut;
+}
 
 PuncturingRule::PuncturingRule(
         const size_t length,
         const uint32_t pattern) :
     d_length(length),
-    d_pattern(pattern)
-{ }
-
-size_t PuncturingRule::bit_size() const
+    d_pattern(pattern),
+    d_bit_size(0)
 {
-    size_t bits = 0;
-    for (uint32_t mask = 0x80000000; mask != 0; mask >>= 1) {
-        if (d_pattern & mask) {
-            ++bits;
+    static const std::vector<uint8_t> lut = build_byte_lut();
+
+    for (int i = 0; i < 4; ++i) {
+        const uint8_t mask = pattern >> (24 - 8 * i);
+        d_byte_lut[i] = &lut[mask << 8];
+        d_byte_bits[i] = 0;
+        for (int j = 0; j < 8; ++j) {
+            if (mask & (1 << j)) {
+                ++d_byte_bits[i];
+            }
         }
+        d_bit_size += d_byte_bits[i];
     }
-    return bits;
 }
@@ -27,6 +27,9 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#ifdef __BMI2__
+#   include <immintrin.h>
+#endif // __BMI2__
 
 class PuncturingRule
 {
@@ -36,11 +39,32 @@ public:
             const uint32_t pattern);
 
     size_t length() const { return d_length; }
-    size_t bit_size() const;
+    size_t bit_size() const { return d_bit_size; }
     const uint32_t pattern() const { return d_pattern; }
 
+    /* Keep the bits of word that are set in the pattern, and return
+     * them packed into the bit_size() least significant bits.
+     */
+    uint32_t puncture(uint32_t word) const {
+#ifdef __BMI2__
+        return _pext_u32(word, d_pattern);
+#else
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) {
+            const uint8_t byte = word >> (24 - 8 * i);
+            bits = (bits << d_byte_bits[i]) | d_byte_lut[i][byte];
+        }
+        return bits;
+#endif // __BMI2__
+    }
+
 private:
     size_t d_length;
     uint32_t d_pattern;
-};
+    size_t d_bit_size;
 
+    // For every byte of the pattern, the table that packs the selected
+    // bits of an input byte, and the number of bits selected
+    const uint8_t* d_byte_lut[4];
+    uint8_t d_byte_bits[4];
+};
@@ -20,18 +20,18 @@
  */
 
 #include "QpskSymbolMapper.h"
+#include "DabModeTraits.h"
 #include "PcDebug.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdexcept>
-#include <complex>
-#include <math.h>
-#ifdef __SSE__
-#   include <xmmintrin.h>
-#endif // __SSE__
 
-typedef std::complex<float> complexf;
+/* Phase index of the QPSK symbol
+ *   y = 1/sqrt(2) * ((1 - 2 * p_real) + j * (1 - 2 * p_imag))
+ * indexed by (p_real << 1) | p_imag, in units of pi/4.
+ */
+static const uint8_t qpsk_phase[4] = { 1, 7, 3, 5 };
 
 
 QpskSymbolMapper::QpskSymbolMapper(size_t carriers) :
@@ -40,6 +40,15 @@ QpskSymbolMapper::QpskSymbolMapper(size_t carriers) :
 {
     PDEBUG("QpskSymbolMapper::QpskSymbolMapper(%zu) @ %p\n", carriers, this);
 
+    for (size_t i = 0; i < 256; ++i) {
+        const uint8_t re = i >> 4;
+        const uint8_t im = i & 0x0f;
+        for (size_t j = 0; j < 4; ++j) {
+            const uint8_t bit_re = (re >> (3 - j)) & 1;
+            const uint8_t bit_im = (im >> (3 - j)) & 1;
+            d_table[i][j] = qpsk_phase[(bit_re << 1) | bit_im];
+        }
+    }
 }
 
 
@@ -56,11 +65,6 @@ int QpskSymbolMapper::process(Buffer* const dataIn, Buffer* dataOut)
             "(dataIn: %p, dataOut: %p)\n",
             dataIn, dataOut);
 
-    dataOut->setLength(dataIn->getLength() * 4 * 2 * sizeof(float));   // 4 output complex symbols per input byte
-#ifdef __SSE__
-    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
-    __m128* out = reinterpret_cast<__m128*>(dataOut->getData());
-
     if (dataIn->getLength() % (d_carriers / 4) != 0) {
         fprintf(stderr, "%zu (input size) %% (%zu (carriers) / 4) != 0\n",
                 dataIn->getLength(), d_carriers);
@@ -68,100 +72,41 @@ int QpskSymbolMapper::process(Buffer* const dataIn, Buffer* dataOut)
                 "QpskSymbolMapper::process input size not valid!");
     }
 
-    const static __m128 symbols[16] = {
-        _mm_setr_ps( M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps( M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,- M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,- M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,- M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2),
-        _mm_setr_ps(-M_SQRT1_2,- M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2)
-    };
-    size_t inOffset = 0;
-    size_t outOffset = 0;
-    uint8_t tmp = 0;
-    for (size_t i = 0; i < dataIn->getLength(); i += d_carriers / 4) {
-        for (size_t j = 0; j < d_carriers / 8; ++j) {
-            tmp =  (in[inOffset] & 0xc0) >> 4;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0xc0) >> 6;
-            out[outOffset] = symbols[tmp];
-            tmp =  (in[inOffset] & 0x30) >> 2;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x30) >> 4;
-            out[outOffset + 1] = symbols[tmp];
-            tmp =  (in[inOffset] & 0x0c);
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x0c) >> 2;
-            out[outOffset + 2] = symbols[tmp];
-            tmp =  (in[inOffset] & 0x03) << 2;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x03);
-            out[outOffset + 3] = symbols[tmp];
-            ++inOffset;
-            outOffset += 4;
-        }
-        inOffset += d_carriers / 8;
-    }
-#else // !__SSE__
+    dataOut->setLength(dataIn->getLength() * 4);   // 4 output phase indices per input byte
+
     const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
-    float* out = reinterpret_cast<float*>(dataOut->getData());
-    if (dataIn->getLength() % (d_carriers / 4) != 0) {
-        throw std::runtime_error(
-                "QpskSymbolMapper::process input size not valid!");
-    }
-    if (dataOut->getLength() / sizeof(float) != dataIn->getLength() * 4 * 2) {    // 4 output complex symbols per input byte
-        throw std::runtime_error(
-                "QpskSymbolMapper::process output size not valid!");
-    }
+    uint8_t* out = reinterpret_cast<uint8_t*>(dataOut->getData());
 
-    const static float symbols[16][4] = {
-        { M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2},
-        { M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2},
-        { M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2},
-        { M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2},
-        { M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2},
-        { M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2},
-        { M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2},
-        { M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2},
-        {-M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2},
-        {-M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2},
-        {-M_SQRT1_2,- M_SQRT1_2,  M_SQRT1_2,  M_SQRT1_2},
-        {-M_SQRT1_2,- M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2},
-        {-M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2},
-        {-M_SQRT1_2,  M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2},
-        {-M_SQRT1_2,- M_SQRT1_2, -M_SQRT1_2,  M_SQRT1_2},
-        {-M_SQRT1_2,- M_SQRT1_2, -M_SQRT1_2, -M_SQRT1_2}
-    };
-    size_t inOffset = 0;
-    size_t outOffset = 0;
-    uint8_t tmp;
     for (size_t i = 0; i < dataIn->getLength(); i += d_carriers / 4) {
-        for (size_t j = 0; j < d_carriers / 8; ++j) {
-            tmp =  (in[inOffset] & 0xc0) >> 4;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0xc0) >> 6;
-            memcpy(&out[outOffset], symbols[tmp], sizeof(float) * 4);
-            tmp =  (in[inOffset] & 0x30) >> 2;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x30) >> 4;
-            memcpy(&out[outOffset + 4], symbols[tmp], sizeof(float) * 4);
-            tmp =  (in[inOffset] & 0x0c);
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x0c) >> 2;
-            memcpy(&out[outOffset + 8], symbols[tmp], sizeof(float) * 4);
-            tmp =  (in[inOffset] & 0x03) << 2;
-            tmp |= (in[inOffset + (d_carriers / 8)] & 0x03);
-            memcpy(&out[outOffset + 12], symbols[tmp], sizeof(float) * 4);
-            ++inOffset;
-            outOffset += 4*4;
-        }
-        inOffset += d_carriers / 8;
+        map_symbol(in + i, out);
+        out += d_carriers;
     }
-#endif // __SSE__
 
     return 1;
 }
 
+
+template<size_t Carriers>
+void QpskSymbolMapper::map_symbol(const uint8_t* in, uint8_t* out) const
+{
+    /* The first half of the symbol carries the real parts, the second half
+     * the imaginary parts of the QPSK symbols.
+     */
+    const size_t halfSymbol = (Carriers ? Carriers : d_carriers) / 8;
+    const uint8_t* re = in;
+    const uint8_t* im = in + halfSymbol;
+    for (size_t j = 0; j < halfSymbol; ++j) {
+        memcpy(out, d_table[(re[j] & 0xf0) | (im[j] >> 4)], 4);
+        memcpy(out + 4, d_table[((re[j] & 0x0f) << 4) | (im[j] & 0x0f)], 4);
+        out += 8;
+    }
+}
+
+
+// Generic kernel, and one with a fixed trip count for each mode
+template void QpskSymbolMapper::map_symbol<0>(const uint8_t*, uint8_t*) const;
+template void QpskSymbolMapper::map_symbol<DabModeTraits<1>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void QpskSymbolMapper::map_symbol<DabModeTraits<2>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void QpskSymbolMapper::map_symbol<DabModeTraits<3>::nbCarriers>(const uint8_t*, uint8_t*) const;
+template void QpskSymbolMapper::map_symbol<DabModeTraits<4>::nbCarriers>(const uint8_t*, uint8_t*) const;
+
@@ -29,8 +29,14 @@
 #include "ModPlugin.h"
 
 #include <sys/types.h>
+#include <stdint.h>
 
-
+/* The QpskSymbolMapper does not output complex symbols, but the phase
+ * of each QPSK symbol as an 8-PSK phase index: one uint8_t per carrier,
+ * where the value n stands for the phase n * pi/4. The QPSK points are
+ * therefore always odd indices. The DifferentialModulator works in the
+ * same phase domain and converts to complex symbols at its output.
+ */
 class QpskSymbolMapper : public ModCodec
 {
 public:
@@ -43,7 +49,20 @@ public:
     int process(Buffer* const dataIn, Buffer* dataOut);
     const char* name() { return "QpskSymbolMapper"; }
 
+    /* Map the d_carriers/4 bytes of one OFDM symbol to d_carriers
+     * phase indices. A non-zero Carriers must be equal to d_carriers, and
+     * fixes the trip count at compile time. Instantiated for 0 and for
+     * the carriers of every DabModeTraits.
+     */
+    template<size_t Carriers = 0>
+    void map_symbol(const uint8_t* in, uint8_t* out) const;
+
 protected:
     size_t d_carriers;
+
+    // Phase indices of the four symbols given by a nibble of the real-part
+    // byte (high 4 bits of the index) and a nibble of the imaginary-part
+    // byte (low 4 bits)
+    uint8_t d_table[256][4];
 };
 
@@ -32,6 +32,7 @@
 #include <boost/thread.hpp>
 
 #include "RemoteControl.h"
+#include "Utils.h"
 
 using boost::asio::ip::tcp;
 using namespace std;
@@ -64,6 +65,23 @@ std::list<std::string> RemoteControllable::get_supported_parameters() const {
     return parameterlist;
 }
 
+static thread_local std::string rc_thread_namespace;
+
+void RemoteControllers::set_thread_namespace(const std::string& ns)
+{
+    rc_thread_namespace = ns;
+}
+
+void RemoteControllers::enrol(RemoteControllable *rc)
+{
+    if (not rc_thread_namespace.empty()) {
+        rc->m_name = rc_thread_namespace + "." + rc->m_name;
+    }
+
+    std::lock_guard<std::mutex> lock(m_controllables_mutex);
+    controllables.push_back(rc);
+}
+
 RemoteControllable* RemoteControllers::get_controllable_(
         const std::string& name)
 {
@@ -85,6 +103,7 @@ void RemoteControllers::set_param(
 {
     etiLog.level(info) << "RC: Setting " << name << " " << param
         << " to " << value;
+    std::lock_guard<std::mutex> lock(m_controllables_mutex);
     RemoteControllable* controllable = get_controllable_(name);
     return controllable->set_parameter(param, value);
 }
@@ -174,6 +193,7 @@ void RemoteControllerTelnet::handle_accept(
 
 void RemoteControllerTelnet::process(long)
 {
+    set_thread_name("rctelnet");
     m_active = true;
 
     while (m_active) {
@@ -228,14 +248,14 @@ void RemoteControllerTelnet::dispatch_command(tcp::socket& socket, string comman
         stringstream ss;
 
         if (cmd.size() == 1) {
-            for (auto &controllable : rcs.controllables) {
+            rcs.for_each_controllable([&](RemoteControllable* controllable) {
                 ss << controllable->get_rc_name() << endl;
 
                 list< vector<string> > params = controllable->get_parameter_descriptions();
                 for (auto &param : params) {
                     ss << "\t" << param[0] << " : " << param[1] << endl;
                 }
-            }
+            });
         }
         else {
             reply(socket, "Too many arguments for command 'list'");
@@ -387,6 +407,7 @@ void RemoteControllerZmq::send_fail_reply(zmq::socket_t &pSocket, const std::str
 
 void RemoteControllerZmq::process()
 {
+    set_thread_name("rczmq");
     // create zmq reply socket for receiving ctrl parameters
     etiLog.level(info) << "Starting zmq remote control thread";
     try {
@@ -415,15 +436,15 @@ void RemoteControllerZmq::process()
                     send_ok_reply(repSocket);
                 }
                 else if (msg.size() == 1 && command == "list") {
-                    size_t cohort_size = rcs.controllables.size();
-                    for (auto &controllable : rcs.controllables) {
-                        std::stringstream ss;
-                        ss << controllable->get_rc_name();
-
-                        std::string msg_s = ss.str();
-
-                        zmq::message_t msg(ss.str().size());
-                        memcpy ((void*) msg.data(), msg_s.data(), msg_s.size());
+                    // Take the names at once, the list may change meanwhile
+                    std::list<std::string> names;
+                    rcs.for_each_controllable([&](RemoteControllable* c) {
+                            names.push_back(c->get_rc_name()); });
+
+                    size_t cohort_size = names.size();
+                    for (auto &name : names) {
+                        zmq::message_t msg(name.size());
+                        memcpy ((void*) msg.data(), name.data(), name.size());
 
                         int flag = (--cohort_size > 0) ? ZMQ_SNDMORE : 0;
                         repSocket.send(msg, flag);
@@ -40,6 +40,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <atomic>
 #include <iostream>
@@ -126,6 +127,8 @@ class RemoteControllable {
         virtual const std::string get_parameter(const std::string& parameter) const = 0;
 
     protected:
+        friend class RemoteControllers;
+
         std::string m_name;
         std::list< std::vector<std::string> > m_parameters;
 };
@@ -138,14 +141,19 @@ class RemoteControllers {
             m_controllers.push_back(rc);
         }
 
-        void enrol(RemoteControllable *rc) {
-            controllables.push_back(rc);
-        }
+        void enrol(RemoteControllable *rc);
 
         void remove_controllable(RemoteControllable *rc) {
+            std::lock_guard<std::mutex> lock(m_controllables_mutex);
             controllables.remove(rc);
         }
 
+        /* Controllables enrolled from the calling thread get their name
+         * prefixed with "ns.", so that the blocks of several modulators
+         * running in one process can be told apart.
+         */
+        static void set_thread_namespace(const std::string& ns);
+
         void check_faults() {
             for (auto &controller : m_controllers) {
                 if (controller->fault_detected())
@@ -157,8 +165,21 @@ class RemoteControllers {
             }
         }
 
+        /* Call f for every enrolled controllable. The registry stays
+         * locked during the iteration, so f must not enrol or remove
+         * controllables.
+         */
+        template<typename F>
+        void for_each_controllable(F f) {
+            std::lock_guard<std::mutex> lock(m_controllables_mutex);
+            for (auto controllable : controllables) {
+                f(controllable);
+            }
+        }
+
         std::list< std::vector<std::string> >
             get_param_list_values(const std::string& name) {
+            std::lock_guard<std::mutex> lock(m_controllables_mutex);
             RemoteControllable* controllable = get_controllable_(name);
 
             std::list< std::vector<std::string> > allparams;
@@ -173,6 +194,7 @@ class RemoteControllers {
         }
 
         std::string get_param(const std::string& name, const std::string& param) {
+            std::lock_guard<std::mutex> lock(m_controllables_mutex);
             RemoteControllable* controllable = get_controllable_(name);
             return controllable->get_parameter(param);
         }
@@ -182,12 +204,20 @@ class RemoteControllers {
                 const std::string& param,
                 const std::string& value);
 
-        std::list<RemoteControllable*> controllables;
-
     private:
+        // Called with m_controllables_mutex held
         RemoteControllable* get_controllable_(const std::string& name);
 
+        std::list<RemoteControllable*> controllables;
+
         std::list<std::shared_ptr<BaseRemoteController> > m_controllers;
+
+        /* Modulators enrol their blocks from their own threads, and the
+         * blocks remove themselves when they are destroyed. Every access
+         * to the controllables holds this mutex, including the calls into
+         * the controllables, so that none gets destroyed while in use.
+         */
+        std::mutex m_controllables_mutex;
 };
 
 extern RemoteControllers rcs;
@@ -25,6 +25,7 @@
  */
 
 #include "Resampler.h"
+#include "FftwWisdom.h"
 #include "PcDebug.h"
 
 #include <malloc.h>
@@ -87,6 +88,7 @@ Resampler::Resampler(size_t inputRate, size_t outputRate, size_t resolution) :
         PDEBUG("Window[%zu] = %f\n", i, myWindow[i]);
     }
 
+    std::unique_lock<std::mutex> lock(fftw_planner_mutex);
     myFftIn = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * myFftSizeIn);
     myFront = (FFT_TYPE*)fftwf_malloc(sizeof(FFT_TYPE) * myFftSizeIn);
     myFftPlan1 = fftwf_plan_dft_1d(myFftSizeIn,
@@ -98,6 +100,7 @@ Resampler::Resampler(size_t inputRate, size_t outputRate, size_t resolution) :
     myFftPlan2 = fftwf_plan_dft_1d(myFftSizeOut,
             myBack, myFftOut,
             FFTW_BACKWARD, FFTW_MEASURE);
+    lock.unlock();
 
     myBufferIn = (complexf*)fftwf_malloc(sizeof(FFT_TYPE) * myFftSizeIn / 2);
     myBufferOut = (complexf*)fftwf_malloc(sizeof(FFT_TYPE) * myFftSizeOut / 2);
@@ -118,6 +121,7 @@ Resampler::~Resampler()
     if (myFront != NULL) { fftwf_free(myFront); }
     if (myBack != NULL) { fftwf_free(myBack); }
     if (myWindow != NULL) { fftwf_free(myWindow); }
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex);
     fftwf_destroy_plan(myFftPlan1);
     fftwf_destroy_plan(myFftPlan2);
 }
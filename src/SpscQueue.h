@@ -0,0 +1,190 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    A bounded single-producer single-consumer lock-free queue
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "Futex.h"
+
+/* This queue is meant to be used by exactly two threads. One producer
+ * that pushes elements into the queue, and one consumer that retrieves
+ * the elements. It replaces the ThreadsafeQueue on the paths that are
+ * taken for every frame, where the mutex and condition variable wake-ups
+ * are noticeable.
+ *
+ * The slots are allocated once at construction. Contrary to the
+ * ThreadsafeQueue, the queue is bounded: push() blocks when all slots
+ * are occupied. A thread that has to wait spins, then sleeps on a futex,
+ * see Futex.h.
+ */
+
+template<typename T>
+class SpscQueue
+{
+public:
+    /* The capacity is rounded up to the next power of two */
+    explicit SpscQueue(size_t capacity) :
+        m_slots(round_up(capacity)),
+        m_mask(m_slots.size() - 1)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscQueue: capacity must not be 0");
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return m_slots.size(); }
+
+    /* Push one element into the queue, waiting for a free slot if the
+     * queue is full, and notify the consumer.
+     *
+     * returns the new queue size.
+     */
+    size_t push(T const& val)
+    {
+        return push_wait_if_full(val, capacity());
+    }
+
+    /* Push one element into the queue, but wait until the queue size
+     * goes below the threshold, which cannot be larger than the capacity.
+     *
+     * returns the new queue size.
+     */
+    size_t push_wait_if_full(T const& val, size_t threshold)
+    {
+        if (threshold == 0 or threshold > capacity()) {
+            throw std::invalid_argument("SpscQueue: invalid threshold");
+        }
+
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head >= threshold) {
+            event_wait(m_pop_event, m_push_waiting, [&]() {
+                    m_cached_head = m_head.load(std::memory_order_acquire);
+                    return tail - m_cached_head < threshold; });
+        }
+
+        m_slots[tail & m_mask] = val;
+        m_tail.store(tail + 1, std::memory_order_release);
+        event_notify(m_push_event, m_pop_waiting);
+
+        return tail + 1 - m_head.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /* Only exact when called from the producer or the consumer */
+    size_t size() const
+    {
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    bool try_pop(T& popped_value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cached_tail == head) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (m_cached_tail == head) {
+                return false;
+            }
+        }
+
+        pop(head, popped_value);
+        return true;
+    }
+
+    /* Wait until the queue contains at least prebuffering elements, and
+     * take one out.
+     */
+    void wait_and_pop(T& popped_value, size_t prebuffering = 1)
+    {
+        if (prebuffering == 0 or prebuffering > capacity()) {
+            throw std::invalid_argument("SpscQueue: invalid prebuffering");
+        }
+
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cached_tail - head < prebuffering) {
+            event_wait(m_push_event, m_pop_waiting, [&]() {
+                    m_cached_tail = m_tail.load(std::memory_order_acquire);
+                    return m_cached_tail - head >= prebuffering; });
+        }
+
+        pop(head, popped_value);
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+
+    static size_t round_up(size_t capacity)
+    {
+        size_t n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+    void pop(size_t head, T& popped_value)
+    {
+        // Move out so that the slot releases what it holds immediately
+        popped_value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        event_notify(m_pop_event, m_push_waiting);
+    }
+
+    std::vector<T> m_slots;
+    const size_t m_mask;
+
+    /* The indices only ever increase, and every member that is written
+     * by one side gets its own cache line, so that the producer and the
+     * consumer do not invalidate each other's caches needlessly.
+     */
+    char m_pad0[cache_line_size];
+
+    // Written by the consumer
+    std::atomic<size_t> m_head{0};
+    std::atomic<uint32_t> m_pop_event{0};
+    std::atomic<uint32_t> m_pop_waiting{0};
+    size_t m_cached_tail = 0;
+    char m_pad1[cache_line_size - 2 * sizeof(size_t) - 2 * sizeof(uint32_t)];
+
+    // Written by the producer
+    std::atomic<size_t> m_tail{0};
+    std::atomic<uint32_t> m_push_event{0};
+    std::atomic<uint32_t> m_push_waiting{0};
+    size_t m_cached_head = 0;
+    char m_pad2[cache_line_size - 2 * sizeof(size_t) - 2 * sizeof(uint32_t)];
+};
+
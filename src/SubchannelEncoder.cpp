@@ -0,0 +1,148 @@
+/*
+   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
+   the Queen in Right of Canada (Communications Research Center Canada)
+
+   Copyright (C) 2016
+   Matthias P. Braendli, matthias.braendli@mpb.li
+
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    This flowgraph block does the channel coding of one subchannel or of
+    the FIC: energy dispersal, convolutional encoding and puncturing.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SubchannelEncoder.h"
+#include "PrbsGenerator.h"
+#include "PcDebug.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/* Feeds the puncturer with the convolutional encoder output of the
+ * scrambled input, one input byte (32 encoded bits) at a time.
+ */
+struct EncoderSource {
+    EncoderSource(const ConvEncoder& encoder,
+            const uint8_t* in, const uint8_t* prbs) :
+        encoder(encoder), in(in), prbs(prbs), previous(0) {}
+
+    uint32_t next() {
+        const uint8_t data = *(in++) ^ *(prbs++);
+        const uint32_t bits = encoder.encode_byte(previous, data);
+        previous = data;
+        return bits;
+    }
+
+    uint32_t tail() {
+        // Six zero bits flush the encoder memory, giving 24 tail bits
+        return encoder.encode_byte(previous, 0) & 0xffffff00;
+    }
+
+    const ConvEncoder& encoder;
+    const uint8_t* in;
+    const uint8_t* prbs;
+    uint8_t previous;
+};
+
+} // anonymous namespace
+
+
+SubchannelEncoder::SubchannelEncoder(
+        size_t framesize,
+        const std::vector<PuncturingRule>& rules,
+        size_t num_cu,
+        std::shared_ptr<EncoderCache> cache) :
+    ModCodec(),
+    d_framesize(framesize),
+    d_prbs(PrbsGenerator::sequence(framesize, 0x110)),
+    d_encoder(framesize),
+    d_puncturer(num_cu),
+    d_cache(cache),
+    d_cache_config(0)
+{
+    PDEBUG("SubchannelEncoder::SubchannelEncoder(%zu, %zu) @ %p\n",
+            framesize, num_cu, this);
+
+    for (const auto& rule : rules) {
+        PDEBUG(" Adding rule:\n");
+        PDEBUG("  Length: %zu\n", rule.length());
+        PDEBUG("  Pattern: 0x%x\n", rule.pattern());
+        d_puncturer.append_rule(rule);
+    }
+    d_puncturer.append_tail_rule(PuncturingRule(3, 0xcccccc));
+
+    if (d_puncturer.getInputSize() != framesize * 4 + 3) {
+        throw std::runtime_error(
+                "SubchannelEncoder puncturing rules cover " +
+                std::to_string(d_puncturer.getInputSize()) +
+                " bytes instead of " + std::to_string(framesize * 4 + 3));
+    }
+
+    if (d_cache) {
+        std::vector<uint64_t> config = { framesize, num_cu };
+        for (const auto& rule : rules) {
+            config.push_back(rule.length());
+            config.push_back(rule.pattern());
+        }
+        d_cache_config = EncoderCache::hash(config.data(),
+                config.size() * sizeof(uint64_t));
+    }
+}
+
+
+int SubchannelEncoder::process(Buffer* const dataIn, Buffer* dataOut)
+{
+    PDEBUG("SubchannelEncoder::process(dataIn: %p, dataOut: %p)\n",
+            dataIn, dataOut);
+
+    if (dataIn->getLength() != d_framesize) {
+        throw std::runtime_error(
+                "SubchannelEncoder::process input size " +
+                std::to_string(dataIn->getLength()) + " expected " +
+                std::to_string(d_framesize));
+    }
+
+    dataOut->setLength(d_puncturer.getOutputSize());
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(dataIn->getData());
+    uint8_t* out = reinterpret_cast<uint8_t*>(dataOut->getData());
+
+    EncoderCache::key_t key;
+    if (d_cache) {
+        key = EncoderCache::make_key(d_cache_config, in, d_framesize);
+        if (d_cache->lookup(key, in, d_framesize,
+                    out, dataOut->getLength())) {
+            return dataOut->getLength();
+        }
+    }
+
+    EncoderSource source(d_encoder, in, d_prbs->data());
+    d_puncturer.puncture(source, out);
+
+    if (d_cache) {
+        d_cache->store(key, in, d_framesize, out, dataOut->getLength());
+    }
+
+    return dataOut->getLength();
+}
@@ -0,0 +1,87 @@
+/*
+   Copyright (C) 2005, 2006, 2007, 2008, 2009, 2010, 2011 Her Majesty
+   the Queen in Right of Canada (Communications Research Center Canada)
+
+   Copyright (C) 2016
+   Matthias P. Braendli, matthias.braendli@mpb.li
+
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    This flowgraph block does the channel coding of one subchannel or of
+    the FIC: energy dispersal, convolutional encoding and puncturing.
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "ConvEncoder.h"
+#include "EncoderCache.h"
+#include "PuncturingEncoder.h"
+#include "PuncturingRule.h"
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+/* The SubchannelEncoder replaces the PrbsGenerator -> ConvEncoder ->
+ * PuncturingEncoder chain. It XORs the energy dispersal sequence, encodes
+ * and punctures in a single pass over the input, and only writes the
+ * punctured output.
+ */
+class SubchannelEncoder : public ModCodec
+{
+public:
+    /* framesize is the size of the input in bytes. If num_cu is not zero,
+     * the output is padded according to EN 300 401 Table 31, see
+     * PuncturingEncoder. The tail rule for the encoder tail bits is added
+     * by the SubchannelEncoder.
+     *
+     * If a cache is given, the output of frames found in it is copied
+     * from there, and the output of the others stored in it.
+     */
+    SubchannelEncoder(
+            size_t framesize,
+            const std::vector<PuncturingRule>& rules,
+            size_t num_cu = 0,
+            std::shared_ptr<EncoderCache> cache = nullptr);
+
+    int process(Buffer* const dataIn, Buffer* dataOut);
+    const char* name() { return "SubchannelEncoder"; }
+
+    size_t getOutputSize() { return d_puncturer.getOutputSize(); }
+
+private:
+    size_t d_framesize;
+    // Energy dispersal sequence, the same for every frame
+    std::shared_ptr<const std::vector<uint8_t> > d_prbs;
+    ConvEncoder d_encoder;
+    PuncturingEncoder d_puncturer;
+
+    std::shared_ptr<EncoderCache> d_cache;
+    // Hash of the parameters of the encoder, part of the cache key
+    uint64_t d_cache_config;
+};
@@ -1048,6 +1048,14 @@ size_t SubchannelSource::protectionOption() const
 void SubchannelSource::loadSubchannelData(const Buffer& data)
 {
     d_buffer = data;
+    d_data = reinterpret_cast<const uint8_t*>(d_buffer.getData());
+    d_data_size = d_buffer.getLength();
+}
+
+void SubchannelSource::loadSubchannelData(const uint8_t* data, size_t size)
+{
+    d_data = data;
+    d_data_size = size;
 }
 
 int SubchannelSource::process(Buffer* outputData)
@@ -1055,13 +1063,13 @@ int SubchannelSource::process(Buffer* outputData)
     PDEBUG("SubchannelSource::process(outputData: %p, outputSize: %zu)\n",
             outputData, outputData->getLength());
 
-    if (d_buffer.getLength() != d_framesize) {
+    if (d_data_size != d_framesize) {
         throw std::runtime_error(
                 "ERROR: Subchannel::process: d_buffer != d_framesize: " +
-                std::to_string(d_buffer.getLength()) + " != " +
+                std::to_string(d_data_size) + " != " +
                 std::to_string(d_framesize));
     }
-    *outputData = d_buffer;
+    outputData->setData(d_data, d_data_size);
 
     return outputData->getLength();
 }
@@ -60,6 +60,10 @@ public:
     const std::vector<PuncturingRule>& get_rules() const;
 
     void loadSubchannelData(const Buffer& data);
+
+    /* Reference the data of the next frame without copying it. It must
+     * stay valid until process() has been called. */
+    void loadSubchannelData(const uint8_t* data, size_t size);
     int process(Buffer* outputData);
     const char* name() { return "SubchannelSource"; }
 
@@ -68,6 +72,8 @@ private:
     size_t d_framesize;
     size_t d_protection;
     Buffer d_buffer;
+    const uint8_t* d_data = nullptr;
+    size_t d_data_size = 0;
     std::vector<PuncturingRule> d_puncturing_rules;
 };
 
@@ -0,0 +1,112 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Symbol-granular streaming of the OFDM back-end
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SymbolStream.h"
+#include "PcDebug.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+SymbolStream::SymbolStream(size_t nbSymbols,
+        size_t nbCarriers,
+        size_t spacing,
+        size_t nullSize,
+        size_t symSize,
+        size_t groupSize,
+        std::shared_ptr<CicEqualizer> cicEq,
+        std::shared_ptr<OfdmGenerator> ofdm,
+        std::shared_ptr<GainControl> gain,
+        std::shared_ptr<GuardIntervalInserter> guard) :
+    ModCodec(),
+    d_nbSymbols(nbSymbols),
+    d_nbCarriers(nbCarriers),
+    d_spacing(spacing),
+    d_nullSize(nullSize),
+    d_symSize(symSize),
+    d_groupSize(std::min(groupSize, nbSymbols)),
+    d_cicEq(cicEq),
+    d_ofdm(ofdm),
+    d_gain(gain),
+    d_guard(guard),
+    d_ofdmState(spacing)
+{
+    PDEBUG("SymbolStream::SymbolStream(%zu, %zu, %zu, %zu) @ %p\n",
+            nbSymbols, nbCarriers, spacing, groupSize, this);
+
+    if (d_groupSize == 0) {
+        throw std::invalid_argument("SymbolStream: group size must not be 0");
+    }
+
+    if (not (d_ofdm and d_gain and d_guard)) {
+        throw std::invalid_argument("SymbolStream: missing block");
+    }
+
+    if (d_cicEq) {
+        d_equalised.resize(d_groupSize * d_nbCarriers);
+    }
+    d_symbols.resize(d_groupSize * d_spacing);
+}
+
+
+int SymbolStream::process(Buffer* const dataIn, Buffer* dataOut)
+{
+    PDEBUG("SymbolStream::process(dataIn: %p, dataOut: %p)\n",
+            dataIn, dataOut);
+
+    const size_t sizeIn = dataIn->getLength() / sizeof(complexf);
+    if (sizeIn != d_nbSymbols * d_nbCarriers) {
+        PDEBUG("%zu != %zu\n", sizeIn, d_nbSymbols * d_nbCarriers);
+        throw std::runtime_error(
+                "SymbolStream::process input size not valid!");
+    }
+
+    dataOut->setLength(
+            (d_nullSize + (d_nbSymbols - 1) * d_symSize) * sizeof(complexf));
+
+    const complexf* in = reinterpret_cast<const complexf*>(dataIn->getData());
+    complexf* out = reinterpret_cast<complexf*>(dataOut->getData());
+
+    for (size_t first = 0; first < d_nbSymbols; first += d_groupSize) {
+        const size_t count = std::min(d_groupSize, d_nbSymbols - first);
+
+        const complexf* carriers = in + first * d_nbCarriers;
+        if (d_cicEq) {
+            d_cicEq->process_symbols(carriers, d_equalised.data(), count);
+            carriers = d_equalised.data();
+        }
+
+        d_ofdm->process_symbols(carriers, d_symbols.data(), first, count,
+                d_ofdmState);
+
+        // The gain is applied in place, it is computed per symbol
+        d_gain->process_symbols(
+                d_symbols.data(), d_symbols.data(), count * d_spacing);
+
+        out += d_guard->process_symbols(d_symbols.data(), out, first, count);
+    }
+
+    return dataOut->getLength() / sizeof(complexf);
+}
+
@@ -0,0 +1,95 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://opendigitalradio.org
+
+    Symbol-granular streaming of the OFDM back-end
+ */
+/*
+   This file is part of ODR-DabMod.
+
+   ODR-DabMod is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMod is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMod.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#   include <config.h>
+#endif
+
+#include "ModPlugin.h"
+#include "CicEqualizer.h"
+#include "OfdmGenerator.h"
+#include "GainControl.h"
+#include "GuardIntervalInserter.h"
+
+#include <sys/types.h>
+#include <complex>
+#include <memory>
+#include <vector>
+
+typedef std::complex<float> complexf;
+
+/* Runs the CicEqualizer (optional), OfdmGenerator, GainControl and
+ * GuardIntervalInserter on groups of a few symbols instead of whole
+ * transmission frames. The intermediate data of a group stays in small
+ * scratch buffers that fit in the cache, instead of going through three
+ * frame-sized buffers. The blocks themselves are still owned by the
+ * DabModulator and remain available through the remote control.
+ *
+ * Unlike the GainControl in the frame-based chain, this block is not
+ * pipelined and does not add a frame of delay.
+ *
+ * Several SymbolStream instances can share the same blocks and process
+ * different frames at the same time, see FrameParallel.
+ */
+class SymbolStream : public ModCodec
+{
+public:
+    SymbolStream(size_t nbSymbols,
+            size_t nbCarriers,
+            size_t spacing,
+            size_t nullSize,
+            size_t symSize,
+            size_t groupSize,
+            std::shared_ptr<CicEqualizer> cicEq,
+            std::shared_ptr<OfdmGenerator> ofdm,
+            std::shared_ptr<GainControl> gain,
+            std::shared_ptr<GuardIntervalInserter> guard);
+    SymbolStream(const SymbolStream&) = delete;
+    SymbolStream& operator=(const SymbolStream&) = delete;
+
+    int process(Buffer* const dataIn, Buffer* dataOut) override;
+    const char* name() override { return "SymbolStream"; }
+
+protected:
+    // Number of symbols including the null symbol
+    size_t d_nbSymbols;
+    size_t d_nbCarriers;
+    size_t d_spacing;
+    size_t d_nullSize;
+    size_t d_symSize;
+    size_t d_groupSize;
+
+    std::shared_ptr<CicEqualizer> d_cicEq;
+    std::shared_ptr<OfdmGenerator> d_ofdm;
+    std::shared_ptr<GainControl> d_gain;
+    std::shared_ptr<GuardIntervalInserter> d_guard;
+
+    std::vector<complexf> d_equalised;
+    std::vector<complexf> d_symbols;
+    OfdmGenerator::FrameState d_ofdmState;
+};
+
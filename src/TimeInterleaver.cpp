@@ -22,22 +22,59 @@
 #include "TimeInterleaver.h"
 #include "PcDebug.h"
 
+#include <string.h>
 #include <vector>
 #include <stdint.h>
 
+namespace {
+
+/* Delay in frames of each output bit, MSB first, for bytes at even and at
+ * odd positions. EN 300 401 Clause 12.
+ */
+const unsigned delay_even[8] = { 0, 8, 4, 12, 2, 10, 6, 14 };
+const unsigned delay_odd[8] =  { 1, 9, 5, 13, 3, 11, 7, 15 };
+
+/* Select bit (0x80 >> bit) in the even, resp. odd, bytes of a 64-bit word,
+ * in memory order.
+ */
+struct BitMasks {
+    uint64_t even[8];
+    uint64_t odd[8];
+
+    BitMasks() {
+        for (int bit = 0; bit < 8; ++bit) {
+            uint8_t e[8], o[8];
+            for (int k = 0; k < 8; k += 2) {
+                e[k] = o[k+1] = 0x80 >> bit;
+                e[k+1] = o[k] = 0;
+            }
+            memcpy(&even[bit], e, sizeof(even[bit]));
+            memcpy(&odd[bit], o, sizeof(odd[bit]));
+        }
+    }
+};
+
+inline uint64_t load64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // anonymous namespace
+
 
 TimeInterleaver::TimeInterleaver(size_t framesize) :
         ModCodec(),
-        d_framesize(framesize)
+        d_framesize(framesize),
+        d_history(16 * framesize, 0),
+        d_row(0)
 {
     PDEBUG("TimeInterleaver::TimeInterleaver(%zu) @ %p\n", framesize, this);
 
     if (framesize & 1) {
         throw std::invalid_argument("framesize must be 16 bits multiple");
     }
-    for (int i = 0; i < 16; ++i) {
-        d_history.emplace_back(framesize, 0);
-    }
 }
 
 
@@ -62,34 +99,42 @@ int TimeInterleaver::process(Buffer* const dataIn, Buffer* dataOut)
     const unsigned char* in = reinterpret_cast<const unsigned char*>(dataIn->getData());
     unsigned char* out = reinterpret_cast<unsigned char*>(dataOut->getData());
 
-    for (size_t i = 0; i < dataOut->getLength();) {
-        d_history.push_front(d_history.back());
-        d_history.pop_back();
-        for (uint_fast16_t j = 0; j < d_framesize;) {
-            d_history[0][j] = in[i];
-            out[i]  = d_history[0] [j] & 0x80;
-            out[i] |= d_history[8] [j] & 0x40;
-            out[i] |= d_history[4] [j] & 0x20;
-            out[i] |= d_history[12][j] & 0x10;
-            out[i] |= d_history[2] [j] & 0x08;
-            out[i] |= d_history[10][j] & 0x04;
-            out[i] |= d_history[6] [j] & 0x02;
-            out[i] |= d_history[14][j] & 0x01;
-            ++i;
-            ++j;
-            d_history[0][j] = in[i];
-            out[i]  = d_history[1] [j] & 0x80;
-            out[i] |= d_history[9] [j] & 0x40;
-            out[i] |= d_history[5] [j] & 0x20;
-            out[i] |= d_history[13][j] & 0x10;
-            out[i] |= d_history[3] [j] & 0x08;
-            out[i] |= d_history[11][j] & 0x04;
-            out[i] |= d_history[7] [j] & 0x02;
-            out[i] |= d_history[15][j] & 0x01;
-            ++i;
-            ++j;
+    static const BitMasks masks;
+
+    // The current frame goes into the ring before being read back
+    memcpy(&d_history[d_row * d_framesize], in, d_framesize);
+
+    // Rows holding the frames delayed according to each output bit
+    const uint8_t* even[8];
+    const uint8_t* odd[8];
+    for (int bit = 0; bit < 8; ++bit) {
+        even[bit] = &d_history[((d_row + 16 - delay_even[bit]) & 15) * d_framesize];
+        odd[bit]  = &d_history[((d_row + 16 - delay_odd[bit])  & 15) * d_framesize];
+    }
+
+    // Merge eight bytes per iteration
+    size_t j = 0;
+    for (; j + 8 <= d_framesize; j += 8) {
+        uint64_t word = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            word |= load64(even[bit] + j) & masks.even[bit];
+            word |= load64(odd[bit] + j) & masks.odd[bit];
         }
+        memcpy(out + j, &word, sizeof(word));
     }
 
+    // framesize is even, the remaining bytes come in pairs
+    for (; j < d_framesize; j += 2) {
+        uint8_t e = 0, o = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            e |= even[bit][j]     & (0x80 >> bit);
+            o |= odd[bit] [j + 1] & (0x80 >> bit);
+        }
+        out[j] = e;
+        out[j + 1] = o;
+    }
+
+    d_row = (d_row + 1) & 15;
+
     return dataOut->getLength();
 }
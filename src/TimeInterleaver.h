@@ -29,8 +29,8 @@
 #include "ModPlugin.h"
 
 #include <vector>
-#include <deque>
 #include <stdexcept>
+#include <stdint.h>
 #include <sys/types.h>
 
 
@@ -40,7 +40,11 @@ private:
 
 protected:
     size_t d_framesize;
-    std::deque<std::vector<unsigned char> > d_history;
+    // The last 16 input frames, one after the other, used as a ring.
+    // Frame n is at row n % 16.
+    std::vector<uint8_t> d_history;
+    // Row that receives the next input frame
+    unsigned d_row;
 
 public:
     TimeInterleaver(size_t framesize);
@@ -27,8 +27,16 @@
 
 #include "Utils.h"
 #include "GainControl.h"
+#include "Log.h"
 #include <sys/prctl.h>
 #include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 
 static void printHeader()
 {
@@ -65,7 +73,9 @@ void printUsage(const char* progName)
 
     FILE* out = stderr;
     fprintf(out, "Usage with configuration file:\n");
-    fprintf(out, "\t%s [-C] config_file.ini\n\n", progName);
+    fprintf(out, "\t%s [-C] config_file.ini\n", progName);
+    fprintf(out, "\t%s --plan-wisdom [-C] config_file.ini\n", progName);
+    fprintf(out, "\t%s --batch[=workers] [-C] config_file.ini\n\n", progName);
 
     fprintf(out, "Usage with command line options:\n");
     fprintf(out, "\t%s"
@@ -81,6 +91,9 @@ void printUsage(const char* progName)
             " [-l]"
             " [-m dabMode]"
             " [-r samplingRate]"
+            " [-W wisdomFile]"
+            " [--plan-wisdom]"
+            " [--batch[=workers]]"
             "\n", progName);
     fprintf(out, "Where:\n");
     fprintf(out, "input:         ETI input filename (default: stdin), or\n");
@@ -103,7 +116,12 @@ void printUsage(const char* progName)
     fprintf(out, "-h:            Print this help.\n");
     fprintf(out, "-l:            Loop file when reach end of file.\n");
     fprintf(out, "-m mode:       Set DAB mode: (0: auto, 1-4: force).\n");
-    fprintf(out, "-r rate:       Set output sampling rate (default: 2048000).\n\n");
+    fprintf(out, "-r rate:       Set output sampling rate (default: 2048000).\n");
+    fprintf(out, "-W file:       Load and save FFTW wisdom in this file, to speed up startup.\n");
+    fprintf(out, "--plan-wisdom: Plan the FFTs for all modes at the output rate, save the\n");
+    fprintf(out, "                  wisdom to the file given with -W or fftw_wisdom, and exit.\n");
+    fprintf(out, "--batch[=n]:   Modulate a file input into a file output as fast as possible, using n\n");
+    fprintf(out, "                  modulators in parallel (default: one per CPU).\n\n");
 }
 
 
@@ -148,8 +166,19 @@ void printStartupInfo()
 #endif
 }
 
+static std::atomic<bool> realtime_prio_enabled(true);
+
+void disable_realtime_prio()
+{
+    realtime_prio_enabled = false;
+}
+
 int set_realtime_prio(int prio)
 {
+    if (not realtime_prio_enabled) {
+        return 0;
+    }
+
     // Set thread priority to realtime
     const int policy = SCHED_RR;
     sched_param sp;
@@ -161,6 +190,147 @@ int set_realtime_prio(int prio)
 void set_thread_name(const char *name)
 {
     prctl(PR_SET_NAME,name,0,0,0);
+
+    if (int ret = apply_thread_config(name, pthread_self())) {
+        etiLog.level(error) << "Could not apply the thread configuration of " <<
+            name << ": " << strerror(ret);
+    }
+}
+
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        const size_t dash = range.find('-');
+        int first = 0;
+        int last = 0;
+        try {
+            size_t end = 0;
+            const std::string first_s = range.substr(0, dash);
+            first = std::stoi(first_s, &end);
+            if (end != first_s.size()) {
+                throw std::invalid_argument(first_s);
+            }
+
+            last = first;
+            if (dash != std::string::npos) {
+                const std::string last_s = range.substr(dash + 1);
+                last = std::stoi(last_s, &end);
+                if (end != last_s.size()) {
+                    throw std::invalid_argument(last_s);
+                }
+            }
+        }
+        catch (const std::logic_error&) {
+            throw std::invalid_argument("malformed CPU range '" + range + "'");
+        }
+
+        if (first < 0 or last < first) {
+            throw std::invalid_argument("invalid CPU range '" + range + "'");
+        }
+
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+static std::mutex thread_config_mutex;
+static std::map<std::string, thread_config_t> thread_config;
+
+// CPUs removed from the scheduler with the isolcpus kernel parameter
+static std::vector<int> isolated_cpus()
+{
+    std::vector<int> cpus;
+
+    std::ifstream isolated("/sys/devices/system/cpu/isolated");
+    std::string list;
+    if (not std::getline(isolated, list)) {
+        return cpus;
+    }
+
+    try {
+        cpus = parse_cpu_list(list);
+    }
+    catch (const std::invalid_argument&) {
+        // Ignore a malformed list, it is informative only
+    }
+    return cpus;
+}
+
+void set_thread_config(const std::map<std::string, thread_config_t>& config)
+{
+    const auto isolated = isolated_cpus();
+
+    for (const auto& entry : config) {
+        bool uses_isolated = false;
+        for (int cpu : entry.second.cpus) {
+            if (cpu < 0 or cpu >= CPU_SETSIZE) {
+                throw std::runtime_error("Thread configuration of " +
+                        entry.first + ": invalid CPU " + std::to_string(cpu));
+            }
+            for (int iso : isolated) {
+                uses_isolated |= (iso == cpu);
+            }
+        }
+
+        const bool realtime = entry.second.policy == SCHED_FIFO or
+            entry.second.policy == SCHED_RR;
+        if (not isolated.empty() and realtime and not uses_isolated) {
+            etiLog.level(warn) << "Real-time threads " << entry.first <<
+                " do not use the isolated CPUs";
+        }
+        else if (uses_isolated and not realtime) {
+            etiLog.level(info) << "Threads " << entry.first <<
+                " run on isolated CPUs without real-time scheduling";
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(thread_config_mutex);
+    thread_config = config;
+}
+
+int apply_thread_config(const std::string& name, pthread_t thread)
+{
+    thread_config_t conf;
+    {
+        std::lock_guard<std::mutex> lock(thread_config_mutex);
+        auto it = thread_config.find(name);
+        if (it == thread_config.end()) {
+            it = thread_config.find("default");
+        }
+        if (it == thread_config.end()) {
+            return 0;
+        }
+        conf = it->second;
+    }
+
+    if (not conf.cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int cpu : conf.cpus) {
+            CPU_SET(cpu, &cpuset);
+        }
+
+        int ret = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    if (conf.policy != -1) {
+        sched_param sp;
+        sp.sched_priority = conf.priority;
+        int ret = pthread_setschedparam(thread, conf.policy, &sp);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    return 0;
 }
 
 double parseChannel(const std::string& chan)
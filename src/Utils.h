@@ -35,7 +35,10 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
 #include <string>
+#include <vector>
+#include <map>
 
 void printUsage(const char* progName);
 
@@ -59,11 +62,45 @@ inline long timespecdiff_us(struct timespec& oldTime, struct timespec& time)
     return tv_sec * 1000 + tv_nsec / 1000;
 }
 
-// Set SCHED_RR with priority prio (0=lowest)
+// Set SCHED_RR with priority prio (0=lowest). Does nothing once realtime
+// priority got disabled.
 int set_realtime_prio(int prio);
 
+// Disable the realtime priority for all threads started afterwards, for
+// offline modulation, where these threads must not starve the machine
+void disable_realtime_prio(void);
+
+// Set the name of the calling thread, and apply the placement
+// configured for this name
 void set_thread_name(const char *name);
 
+// Parse a list of CPUs like 2,3,6-7, the format of the kernel cpulists.
+// Throws std::invalid_argument if the list is malformed.
+std::vector<int> parse_cpu_list(const std::string& list);
+
+// CPU set and scheduling of a class of threads
+struct thread_config_t {
+    // CPUs the threads may run on, empty to keep the inherited set
+    std::vector<int> cpus;
+
+    // Scheduling policy (SCHED_OTHER, SCHED_FIFO, ...), -1 keeps the
+    // policy set by the modulator
+    int policy = -1;
+    int priority = 0;
+};
+
+/* Set the configuration for each thread name given to set_thread_name.
+ * The entry named "default" applies to threads without an entry of their
+ * own. Must be called before the modulator threads are started.
+ */
+void set_thread_config(const std::map<std::string, thread_config_t>& config);
+
+/* Apply the configuration for name to thread, for threads that were
+ * started before set_thread_config was called. Returns 0 or an error
+ * number.
+ */
+int apply_thread_config(const std::string& name, pthread_t thread);
+
 // Convert a channel like 10A to a frequency
 double parseChannel(const std::string& chan);
 